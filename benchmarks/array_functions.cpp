@@ -0,0 +1,86 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <vector>
+#include "module.hpp"
+#include "standard_functions.hpp"
+
+namespace {
+	size_t allocations = 0;
+	
+	constexpr size_t array_size = 100000;
+	constexpr int repetitions = 20;
+	
+	const char* source =
+		"public function number loop_sum() {\n"
+		"	number s = 0;\n"
+		"	for (number i = 0; i < sizeof(values); ++i) {\n"
+		"		s += values[i];\n"
+		"	}\n"
+		"	return s;\n"
+		"}\n"
+		"public function number builtin_sum() {\n"
+		"	return array_sum(values);\n"
+		"}\n"
+		"public function number builtin_dot() {\n"
+		"	return array_dot(values, values);\n"
+		"}\n";
+	
+	template<typename F>
+	void measure(const char* name, F f) {
+		stork::number result = f();
+		
+		size_t before = allocations;
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < repetitions; ++i) {
+			result = f();
+		}
+		auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+		
+		std::cout << name << ": " << elapsed.count() / repetitions << " ms, "
+		          << double(allocations - before) / repetitions << " allocations per call"
+		          << " (result " << result << ")" << std::endl;
+	}
+}
+
+void* operator new(size_t size) {
+	++allocations;
+	if (void* ptr = std::malloc(size ? size : 1)) {
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+	std::free(ptr);
+}
+
+int main() {
+	using namespace stork;
+	
+	stork_module m;
+	add_standard_functions(m);
+	
+	global_binding<std::vector<number> > values = m.bind_global<std::vector<number> >("values");
+	auto loop_sum = m.create_public_function_caller<number>("loop_sum");
+	auto builtin_sum = m.create_public_function_caller<number>("builtin_sum");
+	auto builtin_dot = m.create_public_function_caller<number>("builtin_dot");
+	m.load_source(source);
+	
+	std::vector<number> numbers(array_size);
+	for (size_t i = 0; i < array_size; ++i) {
+		numbers[i] = number(i % 1000) / 1000;
+	}
+	values.assign(numbers);
+	
+	measure("script loop", loop_sum);
+	measure("array_sum", builtin_sum);
+	measure("array_dot", builtin_dot);
+	
+	return 0;
+}
@@ -0,0 +1,91 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include "module.hpp"
+#include "standard_functions.hpp"
+
+namespace {
+	size_t allocations = 0;
+	size_t allocated_bytes = 0;
+	
+	constexpr int function_count = 3000;
+	constexpr int repetitions = 5;
+	
+	std::string create_source() {
+		std::string ret;
+		for (int i = 0; i < function_count; ++i) {
+			std::string name = "f" + std::to_string(i);
+			ret += "function number " + name + "(number x, number[] values) {\n";
+			ret += "	number s = x * " + std::to_string(i) + " + 1;\n";
+			ret += "	for (number i = 0; i < sizeof(values); ++i) {\n";
+			ret += "		if (values[i] > s) {\n";
+			ret += "			s += values[i] / 2;\n";
+			ret += "		} else {\n";
+			ret += "			s -= (values[i] - x) * 3;\n";
+			ret += "		}\n";
+			ret += "	}\n";
+			ret += "	string label = \"" + name + "\" .. tostring(s);\n";
+			ret += "	return s + strlen(label);\n";
+			ret += "}\n";
+		}
+		ret += "public function number main() {\n";
+		ret += "	return f0(1, {1, 2, 3});\n";
+		ret += "}\n";
+		return ret;
+	}
+	
+	void measure(const char* name, const std::string& source, bool arena) {
+		double total_ms = 0;
+		size_t total_allocations = 0;
+		size_t total_bytes = 0;
+		size_t compiled_bytes = 0;
+		
+		for (int i = 0; i < repetitions; ++i) {
+			stork::stork_module m;
+			stork::add_standard_functions(m);
+			m.set_arena_allocation(arena);
+			
+			size_t before_allocations = allocations;
+			size_t before_bytes = allocated_bytes;
+			auto start = std::chrono::steady_clock::now();
+			m.load_source(source);
+			total_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+			total_allocations += allocations - before_allocations;
+			total_bytes += allocated_bytes - before_bytes;
+			compiled_bytes = m.compiled_bytes();
+		}
+		
+		std::cout << name << ": " << total_ms / repetitions << " ms, "
+		          << total_allocations / repetitions << " allocations, "
+		          << total_bytes / repetitions << " heap bytes, "
+		          << compiled_bytes << " arena bytes" << std::endl;
+	}
+}
+
+void* operator new(size_t size) {
+	++allocations;
+	allocated_bytes += size;
+	if (void* ptr = std::malloc(size ? size : 1)) {
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+	std::free(ptr);
+}
+
+int main() {
+	std::string source = create_source();
+	
+	measure("with arena", source, true);
+	measure("without arena", source, false);
+	
+	return 0;
+}
@@ -0,0 +1,104 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <vector>
+#include "module.hpp"
+#include "standard_functions.hpp"
+
+namespace {
+	size_t allocations = 0;
+	
+	constexpr size_t array_size = 10000;
+	constexpr int repetitions = 20;
+	
+	const char* source =
+		"string[] words;\n"
+		"number[][] rows;\n"
+		"public function void init() {\n"
+		"	for (number i = 0; i < sizeof(integers); ++i) {\n"
+		"		words[i] = \"word\" .. tostring(i);\n"
+		"	}\n"
+		"	for (number i = 0; i < sizeof(integers) / 10; ++i) {\n"
+		"		rows[i] = {i, i + 0.5, i * 2, i * 3, i * 4, i * 5, i * 6, i * 7, i * 8, i * 9};\n"
+		"	}\n"
+		"}\n"
+		"public function number integers_tostring() {\n"
+		"	return strlen(tostring(integers));\n"
+		"}\n"
+		"public function number fractions_tostring() {\n"
+		"	return strlen(tostring(fractions));\n"
+		"}\n"
+		"public function number words_tostring() {\n"
+		"	return strlen(tostring(words));\n"
+		"}\n"
+		"public function number rows_tostring() {\n"
+		"	return strlen(tostring(rows));\n"
+		"}\n";
+	
+	template<typename F>
+	void measure(const char* name, F f) {
+		stork::number result = f();
+		
+		size_t before = allocations;
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < repetitions; ++i) {
+			result = f();
+		}
+		auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+		
+		std::cout << name << ": " << elapsed.count() / repetitions << " ms, "
+		          << double(allocations - before) / repetitions << " allocations per call"
+		          << " (" << result << " characters)" << std::endl;
+	}
+}
+
+void* operator new(size_t size) {
+	++allocations;
+	if (void* ptr = std::malloc(size ? size : 1)) {
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+	std::free(ptr);
+}
+
+int main() {
+	using namespace stork;
+	
+	stork_module m;
+	add_standard_functions(m);
+	
+	global_binding<std::vector<number> > integers = m.bind_global<std::vector<number> >("integers");
+	global_binding<std::vector<number> > fractions = m.bind_global<std::vector<number> >("fractions");
+	auto init = m.create_public_function_caller<void>("init");
+	auto integers_tostring = m.create_public_function_caller<number>("integers_tostring");
+	auto fractions_tostring = m.create_public_function_caller<number>("fractions_tostring");
+	auto words_tostring = m.create_public_function_caller<number>("words_tostring");
+	auto rows_tostring = m.create_public_function_caller<number>("rows_tostring");
+	m.load_source(source);
+	
+	std::vector<number> numbers(array_size);
+	for (size_t i = 0; i < array_size; ++i) {
+		numbers[i] = number(i);
+	}
+	integers.assign(numbers);
+	for (size_t i = 0; i < array_size; ++i) {
+		numbers[i] = number(i) / 7;
+	}
+	fractions.assign(numbers);
+	init();
+	
+	measure("integers", integers_tostring);
+	measure("fractions", fractions_tostring);
+	measure("strings", words_tostring);
+	measure("nested", rows_tostring);
+	
+	return 0;
+}
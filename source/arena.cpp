@@ -0,0 +1,81 @@
+#include "arena.hpp"
+#include <new>
+
+namespace stork {
+	namespace {
+		constexpr size_t alignment = alignof(std::max_align_t);
+		constexpr size_t header_size = (sizeof(arena*) + alignment - 1) / alignment * alignment;
+		constexpr size_t initial_block_size = 4096;
+		constexpr size_t max_block_size = 1 << 20;
+		
+		thread_local arena* current_arena = nullptr;
+		
+		size_t align_up(size_t size) {
+			return (size + alignment - 1) / alignment * alignment;
+		}
+	}
+	
+	arena::arena():
+		_current(nullptr),
+		_remaining(0),
+		_block_size(initial_block_size),
+		_used(0)
+	{
+	}
+	
+	void* arena::allocate(size_t size) {
+		size = align_up(size);
+		
+		if (size > _remaining) {
+			if (size > _block_size / 4) {
+				_blocks.emplace_back(new std::byte[size]);
+				_used += size;
+				return _blocks.back().get();
+			}
+			
+			_blocks.emplace_back(new std::byte[_block_size]);
+			_current = _blocks.back().get();
+			_remaining = _block_size;
+			if (_block_size < max_block_size) {
+				_block_size *= 2;
+			}
+		}
+		
+		void* ret = _current;
+		_current += size;
+		_remaining -= size;
+		_used += size;
+		return ret;
+	}
+	
+	size_t arena::bytes_used() const {
+		return _used;
+	}
+	
+	arena_scope::arena_scope(arena* a):
+		_previous(current_arena)
+	{
+		current_arena = a;
+	}
+	
+	arena_scope::~arena_scope() {
+		current_arena = _previous;
+	}
+	
+	void* arena_allocated::operator new(size_t size) {
+		arena* a = current_arena;
+		std::byte* ptr = static_cast<std::byte*>(a ? a->allocate(header_size + size) : ::operator new(header_size + size));
+		*reinterpret_cast<arena**>(ptr) = a;
+		return ptr + header_size;
+	}
+	
+	void arena_allocated::operator delete(void* ptr) {
+		if (!ptr) {
+			return;
+		}
+		std::byte* block = static_cast<std::byte*>(ptr) - header_size;
+		if (!*reinterpret_cast<arena**>(block)) {
+			::operator delete(block);
+		}
+	}
+}
@@ -0,0 +1,43 @@
+#ifndef arena_hpp
+#define arena_hpp
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace stork {
+	class arena {
+		arena(const arena&) = delete;
+		void operator=(const arena&) = delete;
+	private:
+		std::vector<std::unique_ptr<std::byte[]> > _blocks;
+		std::byte* _current;
+		size_t _remaining;
+		size_t _block_size;
+		size_t _used;
+	public:
+		arena();
+		
+		void* allocate(size_t size);
+		
+		size_t bytes_used() const;
+	};
+	
+	class arena_scope {
+		arena_scope(const arena_scope&) = delete;
+		void operator=(const arena_scope&) = delete;
+	private:
+		arena* _previous;
+	public:
+		explicit arena_scope(arena* a);
+		~arena_scope();
+	};
+	
+	class arena_allocated {
+	public:
+		static void* operator new(size_t size);
+		static void operator delete(void* ptr);
+	};
+}
+
+#endif /* arena_hpp */
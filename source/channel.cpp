@@ -0,0 +1,209 @@
+#include "channel.hpp"
+#include <thread>
+#include "errors.hpp"
+
+namespace stork {
+	namespace {
+		constexpr int spin_count = 64;
+
+		std::atomic<uint64_t> next_registry_serial(1);
+
+		struct channel_cache {
+			uint64_t serial = 0;
+			uint64_t generation = 0;
+			std::unordered_map<size_t, std::shared_ptr<channel> > channels;
+		};
+	}
+
+	channel::channel(size_t capacity):
+		_enqueue_pos(0),
+		_dequeue_pos(0),
+		_version(0),
+		_waiters(0),
+		_closed(false)
+	{
+		size_t size = 2;
+		while (size < capacity) {
+			size <<= 1;
+		}
+
+		_buffer = std::make_unique<cell[]>(size);
+		_mask = size - 1;
+
+		for (size_t i = 0; i < size; ++i) {
+			_buffer[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	void channel::notify() {
+		_version.fetch_add(1);
+		if (_waiters.load() > 0) {
+			_version.notify_all();
+		}
+	}
+
+	void channel::wait(uint32_t version) {
+		++_waiters;
+		_version.wait(version);
+		--_waiters;
+	}
+
+	bool channel::try_send(variable_ptr& v) {
+		runtime_assertion(!_closed.load(std::memory_order_relaxed), "Channel is closed");
+
+		cell* c;
+		size_t pos = _enqueue_pos.load(std::memory_order_relaxed);
+
+		while (true) {
+			c = &_buffer[pos & _mask];
+			size_t seq = c->sequence.load(std::memory_order_acquire);
+			intptr_t diff = intptr_t(seq) - intptr_t(pos);
+
+			if (diff == 0) {
+				if (_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if (diff < 0) {
+				return false;
+			} else {
+				pos = _enqueue_pos.load(std::memory_order_relaxed);
+			}
+		}
+
+		c->value = std::move(v);
+		c->sequence.store(pos + 1, std::memory_order_release);
+
+		notify();
+
+		return true;
+	}
+
+	bool channel::try_receive(variable_ptr& v) {
+		cell* c;
+		size_t pos = _dequeue_pos.load(std::memory_order_relaxed);
+
+		while (true) {
+			c = &_buffer[pos & _mask];
+			size_t seq = c->sequence.load(std::memory_order_acquire);
+			intptr_t diff = intptr_t(seq) - intptr_t(pos + 1);
+
+			if (diff == 0) {
+				if (_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+					break;
+				}
+			} else if (diff < 0) {
+				return false;
+			} else {
+				pos = _dequeue_pos.load(std::memory_order_relaxed);
+			}
+		}
+
+		v = std::move(c->value);
+		c->sequence.store(pos + _mask + 1, std::memory_order_release);
+
+		notify();
+
+		return true;
+	}
+
+	void channel::send(variable_ptr v) {
+		for (int i = 0;; ++i) {
+			uint32_t version = _version.load();
+			if (try_send(v)) {
+				return;
+			}
+			if (i < spin_count) {
+				std::this_thread::yield();
+			} else {
+				wait(version);
+			}
+		}
+	}
+
+	variable_ptr channel::receive() {
+		variable_ptr ret;
+		for (int i = 0;; ++i) {
+			uint32_t version = _version.load();
+			if (try_receive(ret)) {
+				return ret;
+			}
+			if (_closed.load() && empty()) {
+				return nullptr;
+			}
+			if (i < spin_count) {
+				std::this_thread::yield();
+			} else {
+				wait(version);
+			}
+		}
+	}
+
+	void channel::close() {
+		_closed.store(true);
+		notify();
+	}
+
+	bool channel::empty() const {
+		return _enqueue_pos.load() == _dequeue_pos.load();
+	}
+
+	channel_registry::channel_registry():
+		_next_id(0),
+		_serial(next_registry_serial.fetch_add(1)),
+		_generation(0)
+	{
+	}
+
+	size_t channel_registry::create(size_t capacity) {
+		std::lock_guard<std::mutex> lock(_mutex);
+		size_t id = _next_id++;
+		_channels.emplace(id, std::make_shared<channel>(capacity));
+		return id;
+	}
+
+	channel& channel_registry::get(size_t id) {
+		thread_local channel_cache cache;
+
+		uint64_t generation = _generation.load(std::memory_order_acquire);
+		if (cache.serial != _serial || cache.generation != generation) {
+			cache.channels.clear();
+			cache.serial = _serial;
+			cache.generation = generation;
+		}
+
+		if (auto it = cache.channels.find(id); it != cache.channels.end()) {
+			return *it->second;
+		}
+
+		std::shared_ptr<channel> ch;
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			auto it = _channels.find(id);
+			runtime_assertion(it != _channels.end(), "Invalid channel id");
+			ch = it->second;
+		}
+
+		return *cache.channels.emplace(id, std::move(ch)).first->second;
+	}
+
+	void channel_registry::close(size_t id) {
+		channel& ch = get(id);
+		ch.close();
+		if (ch.empty()) {
+			release(id);
+		}
+	}
+
+	void channel_registry::release(size_t id) {
+		std::lock_guard<std::mutex> lock(_mutex);
+		if (_channels.erase(id)) {
+			_generation.fetch_add(1, std::memory_order_release);
+		}
+	}
+
+	channel_registry::~channel_registry() {
+		for (auto& p : _channels) {
+			p.second->close();
+		}
+	}
+}
@@ -0,0 +1,65 @@
+#ifndef channel_hpp
+#define channel_hpp
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <cstdint>
+#include "variable.hpp"
+
+namespace stork {
+	class channel {
+		channel(const channel&) = delete;
+		void operator=(const channel&) = delete;
+	private:
+		struct cell {
+			std::atomic<size_t> sequence;
+			variable_ptr value;
+		};
+
+		std::unique_ptr<cell[]> _buffer;
+		size_t _mask;
+		alignas(64) std::atomic<size_t> _enqueue_pos;
+		alignas(64) std::atomic<size_t> _dequeue_pos;
+		alignas(64) std::atomic<uint32_t> _version;
+		std::atomic<int> _waiters;
+		std::atomic<bool> _closed;
+
+		void notify();
+		void wait(uint32_t version);
+	public:
+		explicit channel(size_t capacity);
+
+		bool try_send(variable_ptr& v);
+		bool try_receive(variable_ptr& v);
+
+		void send(variable_ptr v);
+		variable_ptr receive();
+
+		void close();
+		bool empty() const;
+	};
+
+	class channel_registry {
+		channel_registry(const channel_registry&) = delete;
+		void operator=(const channel_registry&) = delete;
+	private:
+		std::mutex _mutex;
+		std::unordered_map<size_t, std::shared_ptr<channel> > _channels;
+		size_t _next_id;
+		uint64_t _serial;
+		std::atomic<uint64_t> _generation;
+	public:
+		channel_registry();
+
+		size_t create(size_t capacity);
+		channel& get(size_t id);
+		void close(size_t id);
+		void release(size_t id);
+
+		~channel_registry();
+	};
+}
+
+#endif /* channel_hpp */
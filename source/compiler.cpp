@@ -2,10 +2,13 @@
 #include "errors.hpp"
 #include "compiler_context.hpp"
 #include "expression.hpp"
+#include "arena.hpp"
 #include "incomplete_function.hpp"
 #include "tokenizer.hpp"
 #include "runtime_context.hpp"
 #include "push_back_stream.hpp"
+#include <mutex>
+#include <deque>
 
 namespace stork {
 	namespace {
@@ -35,6 +38,7 @@ namespace stork {
 							case reserved_token::kw_number:
 							case reserved_token::kw_string:
 							case reserved_token::kw_void:
+							case reserved_token::kw_const:
 							case reserved_token::open_square:
 								return true;
 							default:
@@ -52,7 +56,16 @@ namespace stork {
 			return unexpected_syntax_error(std::to_string(it->get_value()), it->get_line_number(), it->get_char_index());
 		}
 		
-		std::vector<expression<lvalue>::ptr> compile_variable_declaration(compiler_context& ctx, tokens_iterator& it) {
+		std::vector<expression<lvalue>::ptr> compile_variable_declaration(
+			compiler_context& ctx,
+			tokens_iterator& it,
+			std::vector<std::string>* names = nullptr
+		) {
+			bool is_const = it->has_value(reserved_token::kw_const);
+			if (is_const) {
+				++it;
+			}
+			
 			type_handle type_id = parse_type(ctx, it);
 		
 			if (type_id == type_registry::get_void_handle()) {
@@ -79,7 +92,11 @@ namespace stork {
 					ret.emplace_back(build_default_initialization(type_id));
 				}
 				
-				ctx.create_identifier(std::move(name), type_id);
+				if (names) {
+					names->push_back(name);
+				}
+				
+				ctx.create_identifier(std::move(name), type_id, is_const);
 			} while (it->has_value(reserved_token::comma));
 			
 			return ret;
@@ -345,6 +362,14 @@ namespace stork {
 			if (pf.return_type_id == type_registry::get_void_handle()) {
 				parse_token_value(ctx, it, reserved_token::semicolon);
 				return create_return_void_statement();
+			} else if (pf.return_type_id == type_registry::get_number_handle()) {
+				expression<number>::ptr expr = build_number_expression(ctx, it);
+				parse_token_value(ctx, it, reserved_token::semicolon);
+				return create_return_number_statement(std::move(expr));
+			} else if (pf.return_type_id == type_registry::get_string_handle()) {
+				expression<string>::ptr expr = build_string_expression(ctx, it);
+				parse_token_value(ctx, it, reserved_token::semicolon);
+				return create_return_string_statement(std::move(expr));
 			} else {
 				expression<lvalue>::ptr expr = build_initialization_expression(ctx, it, pf.return_type_id, true);
 				parse_token_value(ctx, it, reserved_token::semicolon);
@@ -391,7 +416,7 @@ namespace stork {
 			throw unexpected_syntax(it);
 		}
 
-		std::string ret = it->get_identifier().name;
+		std::string ret(it->get_identifier().name());
 		
 		if (!ctx.can_declare(ret)) {
 			throw already_declared_error(ret, it->get_line_number(), it->get_char_index());
@@ -475,60 +500,160 @@ namespace stork {
 		return t;
 	}
 	
+	namespace {
+		struct function_body {
+			std::shared_ptr<arena> nodes;
+			shared_statement_ptr block;
+		};
+	}
+	
 	shared_statement_ptr compile_function_block(compiler_context& ctx, tokens_iterator& it, type_handle return_type_id) {
+		std::shared_ptr<function_body> body = std::make_shared<function_body>();
+		if (ctx.node_arenas()) {
+			body->nodes = std::make_shared<arena>();
+		}
+		
+		arena_scope scope(body->nodes.get());
 		std::vector<statement_ptr> block = compile_block_contents(ctx, it, possible_flow::in_function(return_type_id));
 		if (return_type_id != type_registry::get_void_handle()) {
 			block.emplace_back(create_return_statement(build_default_initialization(return_type_id)));
 		}
-		return create_shared_block_statement(std::move(block));
+		body->block = create_shared_block_statement(std::move(block));
+		
+		if (body->nodes) {
+			ctx.add_node_bytes(body->nodes->bytes_used());
+		}
+		
+		statement* stmt = body->block.get();
+		return shared_statement_ptr(std::move(body), stmt);
+	}
+	
+	class lazy_functions: public std::enable_shared_from_this<lazy_functions> {
+	private:
+		struct entry {
+			incomplete_function f;
+			std::once_flag once;
+			function compiled;
+			std::string error;
+			
+			entry(incomplete_function f):
+				f(std::move(f))
+			{
+			}
+		};
+		
+		compiler_context _ctx;
+		std::mutex _mutex;
+		std::deque<entry> _entries;
+		
+		const function& get(entry& e) {
+			std::call_once(e.once, [&]() {
+				std::lock_guard<std::mutex> lock(_mutex);
+				try {
+					e.compiled = e.f.compile(_ctx);
+				} catch (const error& err) {
+					e.error = "(" + std::to_string(err.line_number() + 1) + ") " + err.what();
+				}
+			});
+			
+			if (!e.error.empty()) {
+				throw runtime_error(e.error);
+			}
+			
+			return e.compiled;
+		}
+	public:
+		compiler_context& context() {
+			return _ctx;
+		}
+		
+		function add(incomplete_function f) {
+			entry& e = _entries.emplace_back(std::move(f));
+			return [self = shared_from_this(), &e](runtime_context& ctx) {
+				self->get(e)(ctx);
+			};
+		}
+		
+		void compile_all() {
+			for (entry& e : _entries) {
+				get(e);
+			}
+		}
+		
+		size_t node_bytes() {
+			std::lock_guard<std::mutex> lock(_mutex);
+			return _ctx.node_bytes();
+		}
+	};
+	
+	void compile_all(lazy_functions& functions) {
+		functions.compile_all();
+	}
+	
+	size_t node_bytes(lazy_functions& functions) {
+		return functions.node_bytes();
+	}
+	
+	namespace {
+		std::string describe_declaration(std::string_view name, type_handle type_id, bool is_const) {
+			return (is_const ? "const " : "") + std::string(name) + ":" + std::to_string(type_id);
+		}
+		
+		std::string describe_global(compiler_context& ctx, const std::string& name) {
+			const identifier_info* info = ctx.find(name);
+			return describe_declaration(name, info->type_id(), info->is_const());
+		}
 	}
 	
 	runtime_context compile(
 		tokens_iterator& it,
-		const std::vector<std::pair<std::string, function> >& external_functions,
-		std::vector<std::string> public_declarations
+		const std::vector<external_function>& external_functions,
+		const std::vector<std::pair<std::string, type_factory> >& public_declarations,
+		const std::vector<host_global>& host_globals,
+		const compile_options& options
 	) {
-		compiler_context ctx;
+		std::shared_ptr<lazy_functions> lazy_state = std::make_shared<lazy_functions>();
+		compiler_context& ctx = lazy_state->context();
 		
-		for (const std::pair<std::string, function>& p : external_functions) {
-			get_character get = [i = 0, &p]() mutable {
-				if (i < p.first.size()){
-					return int(p.first[i++]);
-				} else {
-					return -1;
+		program_layout layout;
+		
+		for (const external_function& f : external_functions) {
+			if (f.type) {
+				type_handle type_id = f.type(ctx);
+				const identifier_info* info = ctx.create_function(f.name, type_id);
+				if (f.pure) {
+					ctx.add_pure_function(info->index(), f.f);
 				}
-			};
+				ctx.add_read_only_params(info->index(), f.read_only_params);
+				layout.functions.push_back(describe_declaration(f.name, type_id, true));
+				continue;
+			}
 			
-			push_back_stream stream(&get);
+			push_back_stream stream(f.declaration);
 			
 			tokens_iterator function_it(stream);
 		
 			function_declaration decl = parse_function_declaration(ctx, function_it);
 			
 			ctx.create_function(decl.name, decl.type_id);
+			layout.functions.push_back(describe_declaration(decl.name, decl.type_id, true));
 		}
 		
 		std::unordered_map<std::string, type_handle> public_function_types;
 		
-		for (const std::string& f : public_declarations) {
-			get_character get = [i = 0, &f]() mutable {
-				if (i < f.size()){
-					return int(f[i++]);
-				} else {
-					return -1;
-				}
-			};
-			
-			push_back_stream stream(&get);
-			
-			tokens_iterator function_it(stream);
-		
-			function_declaration decl = parse_function_declaration(ctx, function_it);
-			
-			public_function_types.emplace(decl.name, decl.type_id);
+		for (const std::pair<std::string, type_factory>& p : public_declarations) {
+			public_function_types.emplace(p.first, p.second(ctx));
 		}
 
 		std::vector<expression<lvalue>::ptr> initializers;
+		std::vector<bool> shared_globals;
+		
+		for (const host_global& g : host_globals) {
+			ctx.create_identifier(g.name, g.type(ctx), false);
+			initializers.push_back(build_shared_initialization(g.value));
+			shared_globals.push_back(true);
+			layout.globals.push_back(describe_global(ctx, g.name));
+		}
 		
 		std::vector<incomplete_function> incomplete_functions;
 		std::unordered_map<std::string, size_t> public_functions;
@@ -554,17 +679,20 @@ namespace stork {
 						size_t line_number = it->get_line_number();
 						size_t char_index = it->get_char_index();
 						const incomplete_function& f = incomplete_functions.emplace_back(ctx, it);
+						layout.functions.push_back(describe_declaration(f.get_decl().name, f.get_decl().type_id, true));
+						layout.bodies.push_back(f.body_hash());
 						
 						if (public_function) {
 							auto it = public_function_types.find(f.get_decl().name);
 						
-							if (it != public_function_types.end() && it->second != f.get_decl().type_id) {
-								throw semantic_error(
-									"Public function doesn't match it's declaration " + std::to_string(it->second),
-									line_number,
-									char_index
-								);
-							} else {
+							if (it != public_function_types.end()) {
+								if (it->second != f.get_decl().type_id) {
+									throw semantic_error(
+										"Public function doesn't match it's declaration " + std::to_string(it->second),
+										line_number,
+										char_index
+									);
+								}
 								public_function_types.erase(it);
 							}
 						
@@ -576,11 +704,23 @@ namespace stork {
 						break;
 					}
 				default:
-					for (expression<lvalue>::ptr& expr : compile_variable_declaration(ctx, it)) {
-						initializers.push_back(std::move(expr));
+					{
+						bool is_const = it->has_value(reserved_token::kw_const);
+						std::vector<std::string> names;
+						std::vector<expression<lvalue>::ptr> exprs = compile_variable_declaration(ctx, it, &names);
+						for (size_t i = 0; i < exprs.size(); ++i) {
+							if (is_const && exprs[i]->is_constant()) {
+								ctx.add_constant_global(ctx.find(names[i])->index());
+							}
+							initializers.push_back(std::move(exprs[i]));
+							shared_globals.push_back(is_const);
+						}
+						for (const std::string& name : names) {
+							layout.globals.push_back(describe_global(ctx, name));
+						}
+						parse_token_value(ctx, it, reserved_token::semicolon);
+						break;
 					}
-					parse_token_value(ctx, it, reserved_token::semicolon);
-					break;
 			}
 		}
 		
@@ -596,14 +736,50 @@ namespace stork {
 		
 		functions.reserve(external_functions.size() + incomplete_functions.size());
 		
-		for (const std::pair<std::string, function>& p : external_functions) {
-			functions.emplace_back(p.second);
+		for (const external_function& f : external_functions) {
+			functions.emplace_back(f.f);
+		}
+		
+		const program_layout* previous = options.previous;
+		bool reusable = previous && previous->globals == layout.globals && previous->functions == layout.functions;
+		
+		ctx.set_node_arenas(options.node_arenas);
+		
+		for (size_t i = 0; i < incomplete_functions.size(); ++i) {
+			if (reusable && previous->bodies[i] == layout.bodies[i]) {
+				functions.emplace_back(previous->compiled[i]);
+				layout.node_bytes.push_back(previous->node_bytes[i]);
+			} else if (options.lazy) {
+				functions.emplace_back(lazy_state->add(std::move(incomplete_functions[i])));
+				layout.node_bytes.push_back(0);
+			} else {
+				size_t node_bytes = ctx.node_bytes();
+				functions.emplace_back(incomplete_functions[i].compile(ctx));
+				layout.node_bytes.push_back(ctx.node_bytes() - node_bytes);
+			}
+		}
+		
+		if (options.lazy) {
+			*options.lazy = std::move(lazy_state);
+		}
+		
+		if (options.layout) {
+			layout.shared = shared_globals;
+			layout.compiled.assign(functions.begin() + external_functions.size(), functions.end());
+			*options.layout = std::move(layout);
 		}
 		
-		for (incomplete_function& f : incomplete_functions) {
-			functions.emplace_back(f.compile(ctx));
+		std::vector<bool> constant_globals(initializers.size());
+		for (size_t i = 0; i < initializers.size(); ++i) {
+			constant_globals[i] = initializers[i]->is_constant();
 		}
 		
-		return runtime_context(std::move(initializers), std::move(functions), std::move(public_functions));
+		return runtime_context(
+			std::move(initializers),
+			std::move(constant_globals),
+			std::move(shared_globals),
+			std::move(functions),
+			std::move(public_functions)
+		);
 	}
 }
@@ -4,9 +4,11 @@
 #include "types.hpp"
 #include "tokens.hpp"
 #include "statement.hpp"
+#include "compiler_context.hpp"
 
 #include <vector>
 #include <functional>
+#include <memory>
 
 namespace stork {
 	class compiler_context;
@@ -14,13 +16,51 @@ namespace stork {
 	class runtime_context;
 	
 	using function = std::function<void(runtime_context&)>;
+	
+	struct external_function {
+		std::string name;
+		type_factory type;
+		std::string declaration;
+		function f;
+		bool pure;
+		std::vector<bool> read_only_params;
+	};
+	
+	struct host_global {
+		std::string name;
+		type_factory type;
+		variable_ptr value;
+	};
+
+	class lazy_functions;
+	
+	struct program_layout {
+		std::vector<std::string> globals;
+		std::vector<bool> shared;
+		std::vector<std::string> functions;
+		std::vector<uint64_t> bodies;
+		std::vector<function> compiled;
+		std::vector<size_t> node_bytes;
+	};
+	
+	struct compile_options {
+		std::shared_ptr<lazy_functions>* lazy = nullptr;
+		const program_layout* previous = nullptr;
+		program_layout* layout = nullptr;
+		bool node_arenas = true;
+	};
 
 	runtime_context compile(
 		tokens_iterator& it,
-		const std::vector<std::pair<std::string, function> >& external_functions,
-		std::vector<std::string> public_declarations
+		const std::vector<external_function>& external_functions,
+		const std::vector<std::pair<std::string, type_factory> >& public_declarations,
+		const std::vector<host_global>& host_globals,
+		const compile_options& options = {}
 	);
 	
+	void compile_all(lazy_functions& functions);
+	size_t node_bytes(lazy_functions& functions);
+	
 	type_handle parse_type(compiler_context& ctx, tokens_iterator& it);
 
 	std::string parse_declaration_name(compiler_context& ctx, tokens_iterator& it);
@@ -1,10 +1,13 @@
 #include "compiler_context.hpp"
+#include "runtime_context.hpp"
+#include <algorithm>
 
 namespace stork{
-	identifier_info::identifier_info(type_handle type_id, int index, identifier_scope scope) :
+	identifier_info::identifier_info(type_handle type_id, int index, identifier_scope scope, bool is_const) :
 		_type_id(type_id),
 		_index(index),
-		_scope(scope)
+		_scope(scope),
+		_is_const(is_const)
 	{
 	}
 	
@@ -19,16 +22,20 @@ namespace stork{
 	identifier_scope identifier_info::get_scope() const {
 		return _scope;
 	}
+	
+	bool identifier_info::is_const() const {
+		return _is_const;
+	}
 
-	const identifier_info* identifier_lookup::insert_identifier(std::string name, type_handle type_id, int index, identifier_scope scope) {
-		return &_identifiers.emplace(std::move(name), identifier_info(type_id, index, scope)).first->second;
+	const identifier_info* identifier_lookup::insert_identifier(symbol name, type_handle type_id, int index, identifier_scope scope, bool is_const) {
+		return &_identifiers.emplace(name, identifier_info(type_id, index, scope, is_const)).first->second;
 	}
 	
 	int identifier_lookup::identifiers_size() const {
 		return _identifiers.size();
 	}
 
-	const identifier_info* identifier_lookup::find(const std::string& name) const {
+	const identifier_info* identifier_lookup::find(symbol name) const {
 		if (auto it = _identifiers.find(name); it != _identifiers.end()) {
 			return &it->second;
 		} else {
@@ -36,15 +43,15 @@ namespace stork{
 		}
 	}
 	
-	bool identifier_lookup::can_declare(const std::string& name) const {
+	bool identifier_lookup::can_declare(symbol name) const {
 		return _identifiers.find(name) == _identifiers.end();
 	}
 	
 	identifier_lookup::~identifier_lookup() {
 	}
 
-	const identifier_info* global_variable_lookup::create_identifier(std::string name, type_handle type_id) {
-		return insert_identifier(std::move(name), type_id, identifiers_size(), identifier_scope::global_variable);
+	const identifier_info* global_variable_lookup::create_identifier(symbol name, type_handle type_id, bool is_const) {
+		return insert_identifier(name, type_id, identifiers_size(), identifier_scope::global_variable, is_const);
 	}
 
 	local_variable_lookup::local_variable_lookup(std::unique_ptr<local_variable_lookup> parent_lookup) :
@@ -53,7 +60,7 @@ namespace stork{
 	{
 	}
 	
-	const identifier_info* local_variable_lookup::find(const std::string& name) const {
+	const identifier_info* local_variable_lookup::find(symbol name) const {
 		if (const identifier_info* ret = identifier_lookup::find(name)) {
 			return ret;
 		} else {
@@ -61,8 +68,8 @@ namespace stork{
 		}
 	}
 
-	const identifier_info* local_variable_lookup::create_identifier(std::string name, type_handle type_id) {
-		return insert_identifier(std::move(name), type_id, _next_identifier_index++, identifier_scope::local_variable);
+	const identifier_info* local_variable_lookup::create_identifier(symbol name, type_handle type_id, bool is_const) {
+		return insert_identifier(name, type_id, _next_identifier_index++, identifier_scope::local_variable, is_const);
 	}
 	
 	std::unique_ptr<local_variable_lookup> local_variable_lookup::detach_parent() {
@@ -75,16 +82,18 @@ namespace stork{
 	{
 	}
 	
-	const identifier_info* param_lookup::create_param(std::string name, type_handle type_id) {
-		return insert_identifier(std::move(name), type_id, _next_param_index--, identifier_scope::local_variable);
+	const identifier_info* param_lookup::create_param(symbol name, type_handle type_id) {
+		return insert_identifier(name, type_id, _next_param_index--, identifier_scope::local_variable, false);
 	}
 	
-	const identifier_info* function_lookup::create_identifier(std::string name, type_handle type_id) {
-		return insert_identifier(std::move(name), type_id, identifiers_size(), identifier_scope::function);
+	const identifier_info* function_lookup::create_identifier(symbol name, type_handle type_id, bool is_const) {
+		return insert_identifier(name, type_id, identifiers_size(), identifier_scope::function, is_const);
 	}
 
 	compiler_context::compiler_context() :
-		_params(nullptr)
+		_params(nullptr),
+		_node_arenas(true),
+		_node_bytes(0)
 	{
 	}
 	
@@ -93,6 +102,10 @@ namespace stork{
 	}
 	
 	const identifier_info* compiler_context::find(const std::string& name) const {
+		return find(intern(name));
+	}
+	
+	const identifier_info* compiler_context::find(symbol name) const {
 		if (_locals) {
 			if (const identifier_info* ret = _locals->find(name)) {
 				return ret;
@@ -104,20 +117,79 @@ namespace stork{
 		return _globals.find(name);
 	}
 	
-	const identifier_info* compiler_context::create_identifier(std::string name, type_handle type_id) {
+	const identifier_info* compiler_context::create_identifier(std::string name, type_handle type_id, bool is_const) {
 		if (_locals) {
-			return _locals->create_identifier(std::move(name), type_id);
+			return _locals->create_identifier(intern(name), type_id, is_const);
 		} else {
-			return _globals.create_identifier(std::move(name), type_id);
+			return _globals.create_identifier(intern(name), type_id, is_const);
 		}
 	}
 	
 	const identifier_info* compiler_context::create_param(std::string name, type_handle type_id) {
-		return _params->create_param(name, type_id);
+		return _params->create_param(intern(name), type_id);
 	}
 	
 	const identifier_info* compiler_context::create_function(std::string name, type_handle type_id) {
-		return _functions.create_identifier(name, type_id);
+		return _functions.create_identifier(intern(name), type_id, true);
+	}
+	
+	void compiler_context::add_pure_function(int index, stork::function f) {
+		_pure_functions.emplace(index, std::move(f));
+	}
+	
+	const stork::function* compiler_context::get_pure_function(int index) const {
+		if (auto it = _pure_functions.find(index); it != _pure_functions.end()) {
+			return &it->second;
+		} else {
+			return nullptr;
+		}
+	}
+	
+	void compiler_context::add_read_only_params(int index, std::vector<bool> read_only_params) {
+		if (std::find(read_only_params.begin(), read_only_params.end(), true) != read_only_params.end()) {
+			_read_only_params.emplace(index, std::move(read_only_params));
+		}
+	}
+	
+	bool compiler_context::is_read_only_param(int index, size_t param) const {
+		if (auto it = _read_only_params.find(index); it != _read_only_params.end()) {
+			return param < it->second.size() && it->second[param];
+		} else {
+			return false;
+		}
+	}
+	
+	void compiler_context::add_constant_global(int index) {
+		_constant_globals.insert(index);
+	}
+	
+	bool compiler_context::is_constant_global(int index) const {
+		return _constant_globals.count(index) > 0;
+	}
+	
+	runtime_context& compiler_context::folding_context() {
+		if (!_folding_context) {
+			_folding_context = std::make_unique<runtime_context>(
+				std::vector<expression<lvalue>::ptr>(), std::vector<bool>(), std::vector<bool>(), std::vector<stork::function>(), std::unordered_map<std::string, size_t>()
+			);
+		}
+		return *_folding_context;
+	}
+	
+	void compiler_context::set_node_arenas(bool node_arenas) {
+		_node_arenas = node_arenas;
+	}
+	
+	bool compiler_context::node_arenas() const {
+		return _node_arenas;
+	}
+	
+	void compiler_context::add_node_bytes(size_t bytes) {
+		_node_bytes += bytes;
+	}
+	
+	size_t compiler_context::node_bytes() const {
+		return _node_bytes;
 	}
 	
 	void compiler_context::enter_scope() {
@@ -139,7 +211,11 @@ namespace stork{
 	}
 	
 	bool compiler_context::can_declare(const std::string& name) const {
-		return _locals ? _locals->can_declare(name) : (_globals.can_declare(name) && _functions.can_declare(name));
+		symbol s = intern(name);
+		return _locals ? _locals->can_declare(s) : (_globals.can_declare(s) && _functions.can_declare(s));
+	}
+	
+	compiler_context::~compiler_context() {
 	}
 	
 	compiler_context::scope_raii compiler_context::scope() {
@@ -2,12 +2,17 @@
 #define compiler_context_hpp
 
 #include <unordered_map>
+#include <unordered_set>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "types.hpp"
+#include "variable.hpp"
+#include "symbols.hpp"
 
 namespace stork {
+	class runtime_context;
 
 	enum struct identifier_scope {
 		global_variable,
@@ -20,35 +25,38 @@ namespace stork {
 		type_handle _type_id;
 		int _index;
 		identifier_scope _scope;
+		bool _is_const;
 	public:
-		identifier_info(type_handle type_id, int index, identifier_scope scope);
+		identifier_info(type_handle type_id, int index, identifier_scope scope, bool is_const);
 		
 		type_handle type_id() const;
 		
 		int index() const;
 		
 		identifier_scope get_scope() const;
+		
+		bool is_const() const;
 	};
 	
 	class identifier_lookup {
 	private:
-		std::unordered_map<std::string, identifier_info> _identifiers;
+		std::unordered_map<symbol, identifier_info> _identifiers;
 	protected:
-		const identifier_info* insert_identifier(std::string name, type_handle type_id, int index, identifier_scope scope);
+		const identifier_info* insert_identifier(symbol name, type_handle type_id, int index, identifier_scope scope, bool is_const);
 		int identifiers_size() const;
 	public:
-		virtual const identifier_info* find(const std::string& name) const;
+		virtual const identifier_info* find(symbol name) const;
 		
-		virtual const identifier_info* create_identifier(std::string name, type_handle type_id) = 0;
+		virtual const identifier_info* create_identifier(symbol name, type_handle type_id, bool is_const) = 0;
 		
-		bool can_declare(const std::string& name) const;
+		bool can_declare(symbol name) const;
 		
 		virtual ~identifier_lookup();
 	};
 	
 	class global_variable_lookup: public identifier_lookup {
 	public:
-		const identifier_info* create_identifier(std::string name, type_handle type_id) override;
+		const identifier_info* create_identifier(symbol name, type_handle type_id, bool is_const) override;
 	};
 	
 	class local_variable_lookup: public identifier_lookup {
@@ -58,9 +66,9 @@ namespace stork {
 	public:
 		local_variable_lookup(std::unique_ptr<local_variable_lookup> parent_lookup);
 		
-		const identifier_info* find(const std::string& name) const override;
+		const identifier_info* find(symbol name) const override;
 
-		const identifier_info* create_identifier(std::string name, type_handle type_id) override;
+		const identifier_info* create_identifier(symbol name, type_handle type_id, bool is_const) override;
 		
 		std::unique_ptr<local_variable_lookup> detach_parent();
 	};
@@ -71,14 +79,18 @@ namespace stork {
 	public:
 		param_lookup();
 		
-		const identifier_info* create_param(std::string name, type_handle type_id);
+		const identifier_info* create_param(symbol name, type_handle type_id);
 	};
 	
 	class function_lookup: public identifier_lookup {
 	public:
-		const identifier_info* create_identifier(std::string name, type_handle type_id) override;
+		const identifier_info* create_identifier(symbol name, type_handle type_id, bool is_const) override;
 	};
 	
+	class compiler_context;
+	
+	using type_factory = type_handle(*)(compiler_context&);
+	
 	class compiler_context {
 	private:
 		function_lookup _functions;
@@ -86,6 +98,12 @@ namespace stork {
 		param_lookup* _params;
 		std::unique_ptr<local_variable_lookup> _locals;
 		type_registry _types;
+		std::unordered_map<int, stork::function> _pure_functions;
+		std::unordered_map<int, std::vector<bool> > _read_only_params;
+		std::unordered_set<int> _constant_globals;
+		std::unique_ptr<runtime_context> _folding_context;
+		bool _node_arenas;
+		size_t _node_bytes;
 		
 		class scope_raii {
 		private:
@@ -111,18 +129,41 @@ namespace stork {
 		
 		type_handle get_handle(const type& t);
 		
+		const identifier_info* find(symbol name) const;
 		const identifier_info* find(const std::string& name) const;
 		
-		const identifier_info* create_identifier(std::string name, type_handle type_id);
+		const identifier_info* create_identifier(std::string name, type_handle type_id, bool is_const);
 		
 		const identifier_info* create_param(std::string name, type_handle type_id);
 		
 		const identifier_info* create_function(std::string name, type_handle type_id);
 		
+		void add_pure_function(int index, stork::function f);
+		
+		const stork::function* get_pure_function(int index) const;
+		
+		void add_read_only_params(int index, std::vector<bool> read_only_params);
+		
+		bool is_read_only_param(int index, size_t param) const;
+		
+		void add_constant_global(int index);
+		
+		bool is_constant_global(int index) const;
+		
+		runtime_context& folding_context();
+		
+		void set_node_arenas(bool node_arenas);
+		bool node_arenas() const;
+		
+		void add_node_bytes(size_t bytes);
+		size_t node_bytes() const;
+		
 		bool can_declare(const std::string& name) const;
 		
 		scope_raii scope();
 		function_raii function();
+		
+		~compiler_context();
 	};
 }
 
@@ -98,29 +98,27 @@ namespace stork {
 		return semantic_error(message, line_number, char_index);
 	}
 
-	void format_error(const error& err, const get_character& source, std::ostream& output) {
+	void format_error(const error& err, std::string_view source, std::ostream& output) {
 		output << "(" << (err.line_number() + 1) << ") " << err.what() << std::endl;
 		
-		size_t char_index = 0;
+		size_t line_start = 0;
 		
-		for (size_t line_number = 0; line_number < err.line_number(); ++char_index) {
-			int c = source();
-			if (c < 0) {
+		for (size_t line_number = 0; line_number < err.line_number(); ++line_number) {
+			line_start = source.find('\n', line_start);
+			if (line_start == std::string_view::npos) {
 				return;
-			} else if (c == '\n') {
-				++line_number;
 			}
+			++line_start;
 		}
 
-		size_t index_in_line = err.char_index() - char_index;
+		size_t index_in_line = err.char_index() - line_start;
 		
-		std::string line;
-		for (size_t idx = 0;; ++idx) {
-			int c = source();
-			if (c < 0 || c == '\n' || c == '\r') {
-				break;
+		size_t line_end = source.find_first_of("\r\n", line_start);
+		std::string line(source.substr(line_start, line_end == std::string_view::npos ? line_end : line_end - line_start));
+		for (char& c : line) {
+			if (c == '\t') {
+				c = ' ';
 			}
-			line += char(c == '\t' ? ' ' : c);
 		}
 		
 		output << line << std::endl;
@@ -34,8 +34,7 @@ namespace stork {
 	                       size_t line_number, size_t char_index);
 	error already_declared_error(std::string_view name, size_t line_number, size_t char_index);
 
-	using get_character = std::function<int()>;
-	void format_error(const error& err, const get_character& source, std::ostream& output);
+	void format_error(const error& err, std::string_view source, std::ostream& output);
 	
 	
 	class runtime_error: public std::exception {
@@ -75,15 +75,21 @@ namespace stork {
 		class global_variable_expression: public expression<R> {
 		private:
 			int _idx;
+			bool _constant;
 		public:
-			global_variable_expression(int idx) :
-				_idx(idx)
+			global_variable_expression(int idx, bool constant) :
+				_idx(idx),
+				_constant(constant)
 			{
 			}
 			
 			R evaluate(runtime_context& context) const override {
 				return convert<R>(context.global(_idx)->template static_pointer_downcast<T>());
 			}
+			
+			bool is_constant() const override {
+				return _constant;
+			}
 		};
 		
 		template<typename R, typename T>
@@ -129,6 +135,10 @@ namespace stork {
 			R evaluate(runtime_context& context) const override {
 				return convert<R>(_c);
 			}
+			
+			bool is_constant() const override {
+				return true;
+			}
 		};
 
 		template<class O, typename R, typename... Ts>
@@ -158,6 +168,15 @@ namespace stork {
 					_exprs
 				);
 			}
+			
+			bool is_constant() const override {
+				return std::apply(
+					[](const auto&... exprs){
+						return (exprs->is_constant() && ...);
+					},
+					_exprs
+				);
+			}
 		};
 
 #define UNARY_EXPRESSION(name, code)\
@@ -409,6 +428,7 @@ namespace stork {
 			typename expression<A>::ptr _expr1;
 			expression<number>::ptr _expr2;
 			expression<lvalue>::ptr _init;
+			bool _constant;
 			
 			static array& value(A& arr){
 				if constexpr(std::is_same<larray, A>::value) {
@@ -428,10 +448,16 @@ namespace stork {
 				}
 			}
 		public:
-			index_expression(typename expression<A>::ptr expr1, expression<number>::ptr expr2, expression<lvalue>::ptr init):
+			index_expression(
+				typename expression<A>::ptr expr1,
+				expression<number>::ptr expr2,
+				expression<lvalue>::ptr init,
+				bool constant
+			):
 				_expr1(std::move(expr1)),
 				_expr2(std::move(expr2)),
-				_init(std::move(init))
+				_init(std::move(init)),
+				_constant(constant)
 			{
 			}
 		
@@ -440,8 +466,9 @@ namespace stork {
 				int idx = int(_expr2->evaluate(context));
 				
 				runtime_assertion(idx >= 0, "Negative index is invalid");
+				runtime_assertion(!_constant || size_t(idx) < value(arr).size(), "Index is out of range of a constant array");
 				
-				while (idx >= value(arr).size()) {
+				while (size_t(idx) >= value(arr).size()) {
 					value(arr).push_back(_init->evaluate(context));
 				}
 
@@ -496,19 +523,56 @@ namespace stork {
 		template<typename R, typename T>
 		class call_expression: public expression<R>{
 		private:
+			static constexpr size_t inline_params = 4;
+			
 			expression<function>::ptr _fexpr;
+			int _idx;
 			std::vector<expression<lvalue>::ptr> _exprs;
+			
+			template<typename Params>
+			R call(runtime_context& context, Params params) const {
+				function dynamic;
+				const function& f = _fexpr ? (dynamic = _fexpr->evaluate(context)) : context.get_function(_idx);
+				
+				auto frame = context.enter_frame(std::move(params));
+				
+				if constexpr (std::is_same<R, void>::value) {
+					frame.call(f);
+				} else {
+					return convert<R>(std::move(
+						std::static_pointer_cast<variable_impl<T> >(frame.call(f))->value
+					));
+				}
+			}
 		public:
 			call_expression(
 				expression<function>::ptr fexpr,
 				std::vector<expression<lvalue>::ptr> exprs
 			):
 				_fexpr(std::move(fexpr)),
+				_idx(-1),
+				_exprs(std::move(exprs))
+			{
+			}
+			
+			call_expression(
+				int idx,
+				std::vector<expression<lvalue>::ptr> exprs
+			):
+				_idx(idx),
 				_exprs(std::move(exprs))
 			{
 			}
 			
 			R evaluate(runtime_context& context) const override {
+				if (_exprs.size() <= inline_params) {
+					variable_ptr params[inline_params];
+					for (size_t i = 0; i < _exprs.size(); ++i) {
+						params[i] = _exprs[i]->evaluate(context);
+					}
+					return call(context, std::span<const variable_ptr>(params, _exprs.size()));
+				}
+				
 				std::vector<variable_ptr> params;
 				params.reserve(_exprs.size());
 			
@@ -516,15 +580,7 @@ namespace stork {
 					params.push_back(_exprs[i]->evaluate(context));
 				}
 				
-				function f = _fexpr->evaluate(context);
-				
-				if constexpr (std::is_same<R, void>::value) {
-					context.call(f, std::move(params));
-				} else {
-					return convert<R>(std::move(
-						std::static_pointer_cast<variable_impl<T> >(context.call(f, std::move(params)))->value
-					));
-				}
+				return call(context, std::move(params));
 			}
 		};
 		
@@ -553,6 +609,15 @@ namespace stork {
 					return lst;
 				}
 			}
+			
+			bool is_constant() const override {
+				for (const expression<lvalue>::ptr& expr : _exprs) {
+					if (!expr->is_constant()) {
+						return false;
+					}
+				}
+				return true;
+			}
 		};
 	
 		template <typename T>
@@ -568,6 +633,10 @@ namespace stork {
 			lvalue evaluate(runtime_context& context) const override {
 				return std::make_shared<variable_impl<T> >(_expr->evaluate(context));
 			}
+			
+			bool is_constant() const override {
+				return _expr->is_constant();
+			}
 		};
 		
 		struct expression_builder_error {
@@ -593,10 +662,140 @@ namespace stork {
 				
 				return std::make_unique<variable_impl<tuple> >(std::move(ret));
 			}
+			
+			bool is_constant() const override {
+				for (const expression<lvalue>::ptr& expr : _exprs) {
+					if (!expr->is_constant()) {
+						return false;
+					}
+				}
+				return true;
+			}
 		};
 		
 		expression<lvalue>::ptr build_lvalue_expression(type_handle type_id, const node_ptr& np, compiler_context& context);
 		
+		bool is_constant_variable(const node_ptr& np, compiler_context& context) {
+			if (!np->is_identifier()) {
+				return false;
+			}
+			const identifier_info* info = context.find(std::get<identifier>(np->get_value()).id);
+			return info->get_scope() != identifier_scope::function && info->is_const();
+		}
+		
+		int direct_function_index(const node_ptr& callee, compiler_context& context) {
+			if (!callee->is_identifier()) {
+				return -1;
+			}
+			const identifier_info* info = context.find(std::get<identifier>(callee->get_value()).id);
+			return info->get_scope() == identifier_scope::function ? info->index() : -1;
+		}
+		
+		bool is_read_only_param(const node_ptr& callee, size_t param, compiler_context& context) {
+			if (!callee->is_identifier()) {
+				return false;
+			}
+			const identifier_info* info = context.find(std::get<identifier>(callee->get_value()).id);
+			return info->get_scope() == identifier_scope::function && context.is_read_only_param(info->index(), param);
+		}
+		
+		bool fold_constant(const node_ptr& np, compiler_context& context, variable_ptr& value);
+		
+		bool fold_pure_call(const node_ptr& np, compiler_context& context, variable_ptr& value) {
+			const node_ptr& callee = np->get_children()[0];
+			if (!callee->is_identifier()) {
+				return false;
+			}
+			
+			const identifier_info* info = context.find(std::get<identifier>(callee->get_value()).id);
+			if (info->get_scope() != identifier_scope::function) {
+				return false;
+			}
+			
+			const function* f = context.get_pure_function(info->index());
+			if (!f) {
+				return false;
+			}
+			
+			const function_type* ft = std::get_if<function_type>(callee->get_type_id());
+			std::vector<variable_ptr> params;
+			
+			for (size_t i = 1; i < np->get_children().size(); ++i) {
+				const node_ptr& child = np->get_children()[i];
+				if (!child->is_node_operation() || child->get_node_operation() != node_operation::param) {
+					return false;
+				}
+				
+				const node_ptr& arg = child->get_children()[0];
+				variable_ptr param;
+				if (arg->get_type_id() != ft->param_type_id[i-1].type_id || !fold_constant(arg, context, param)) {
+					return false;
+				}
+				params.push_back(std::move(param));
+			}
+			
+			try {
+				value = context.folding_context().call(*f, std::move(params));
+				return value != nullptr;
+			} catch (...) {
+				return false;
+			}
+		}
+		
+		bool fold_constant(const node_ptr& np, compiler_context& context, variable_ptr& value) {
+			if (np->is_number()) {
+				value = std::make_shared<variable_impl<number> >(np->get_number());
+				return true;
+			}
+			
+			if (np->is_string()) {
+				value = std::make_shared<variable_impl<string> >(std::make_shared<std::string>(np->get_string()));
+				return true;
+			}
+			
+			if (!np->is_node_operation()) {
+				return false;
+			}
+			
+			switch (np->get_node_operation()) {
+				case node_operation::call:
+					return fold_pure_call(np, context, value);
+				case node_operation::negative:
+					if (
+						np->get_children()[0]->get_type_id() == type_registry::get_number_handle() &&
+						fold_constant(np->get_children()[0], context, value)
+					) {
+						value = std::make_shared<variable_impl<number> >(-value->static_pointer_downcast<lnumber>()->value);
+						return true;
+					}
+					return false;
+				default:
+					return false;
+			}
+		}
+		
+		template<typename R, typename T>
+		typename expression<R>::ptr build_folded_call_expression(const node_ptr& np, compiler_context& context) {
+			if constexpr(std::is_same<T, number>::value || std::is_same<T, string>::value) {
+				if (variable_ptr folded; fold_pure_call(np, context, folded)) {
+					return std::make_unique<constant_expression<R, T> >(
+						folded->static_pointer_downcast<std::shared_ptr<variable_impl<T> > >()->value
+					);
+				}
+			}
+			return nullptr;
+		}
+		
+		template<typename T, typename R = T>
+		typename expression<R>::ptr build_constant_variable_expression(const node_ptr& np, compiler_context& context) {
+			const identifier_info* info = context.find(std::get<identifier>(np->get_value()).id);
+			if (info->get_scope() == identifier_scope::global_variable) {
+				return std::make_unique<global_variable_expression<R, T> >(info->index(), context.is_constant_global(info->index()));
+			} else {
+				return std::make_unique<local_variable_expression<R, T> >(info->index());
+			}
+		}
+		
 #define RETURN_EXPRESSION_OF_TYPE(T)\
 	if constexpr(is_convertible<T, R>::value) {\
 		return build_##T##_expression(np, context);\
@@ -608,10 +807,10 @@ namespace stork {
 #define CHECK_IDENTIFIER(T1)\
 	if (std::holds_alternative<identifier>(np->get_value())) {\
 		const identifier& id = std::get<identifier>(np->get_value());\
-		const identifier_info* info = context.find(id.name);\
+		const identifier_info* info = context.find(id.id);\
 		switch (info->get_scope()) {\
 			case identifier_scope::global_variable:\
-				return std::make_unique<global_variable_expression<R, T1> >(info->index());\
+				return std::make_unique<global_variable_expression<R, T1> >(info->index(), context.is_constant_global(info->index()));\
 			case identifier_scope::local_variable:\
 				return std::make_unique<local_variable_expression<R, T1> >(info->index());\
 			case identifier_scope::function:\
@@ -622,7 +821,7 @@ namespace stork {
 #define CHECK_FUNCTION()\
 	if (std::holds_alternative<identifier>(np->get_value())) {\
 		const identifier& id = std::get<identifier>(np->get_value());\
-		const identifier_info* info = context.find(id.name);\
+		const identifier_info* info = context.find(id.id);\
 		switch (info->get_scope()) {\
 			case identifier_scope::global_variable:\
 			case identifier_scope::local_variable:\
@@ -643,6 +842,13 @@ namespace stork {
 #define CHECK_SIZE_OPERATION()\
 	case node_operation::size:\
 		if (std::holds_alternative<array_type>(*(np->get_children()[0]->get_type_id()))) {\
+			if (is_constant_variable(np->get_children()[0], context)) {\
+				return expression_ptr(\
+					std::make_unique<size_expression<R, larray> > (\
+						build_constant_variable_expression<larray>(np->get_children()[0], context)\
+					)\
+				);\
+			}\
 			return expression_ptr(\
 				std::make_unique<size_expression<R, larray> > (\
 					expression_builder<larray>::build_expression(np->get_children()[0], context)\
@@ -739,6 +945,27 @@ namespace stork {
 		case node_operation::index:\
 			{\
 				const tuple_type* tt = std::get_if<tuple_type>(np->get_children()[0]->get_type_id());\
+				if constexpr(std::is_same<A, array>::value) {\
+					const bool constant = is_constant_variable(np->get_children()[0], context);\
+					if (constant && tt) {\
+						return expression_ptr(\
+							std::make_unique<member_expression<R, larray, std::shared_ptr<variable_impl<T> > > >(\
+								build_constant_variable_expression<larray>(np->get_children()[0], context),\
+								size_t(np->get_children()[1]->get_number())\
+							)\
+						);\
+					} else if (constant) {\
+						const array_type* at = std::get_if<array_type>(np->get_children()[0]->get_type_id());\
+						return expression_ptr(\
+							std::make_unique<index_expression<R, larray, std::shared_ptr<variable_impl<T> > > >(\
+								build_constant_variable_expression<larray>(np->get_children()[0], context),\
+								expression_builder<number>::build_expression(np->get_children()[1], context),\
+								build_default_initialization(at->inner_type_id),\
+								true\
+							)\
+						);\
+					}\
+				}\
 				if (tt) {\
 					return expression_ptr(\
 						std::make_unique<member_expression<R, A, T> >(\
@@ -752,7 +979,8 @@ namespace stork {
 						std::make_unique<index_expression<R, A, T> >(\
 							expression_builder<A>::build_expression(np->get_children()[0], context),\
 							expression_builder<number>::build_expression(np->get_children()[1], context),\
-							build_default_initialization(at->inner_type_id) \
+							build_default_initialization(at->inner_type_id),\
+							false\
 						)\
 					);\
 				}\
@@ -761,11 +989,26 @@ namespace stork {
 #define CHECK_CALL_OPERATION(T)\
 	case node_operation::call:\
 	{\
+		if (expression_ptr folded = build_folded_call_expression<R, T>(np, context)) {\
+			return folded;\
+		}\
 		std::vector<expression<lvalue>::ptr> arguments;\
 		const function_type* ft = std::get_if<function_type>(np->get_children()[0]->get_type_id());\
 		for (size_t i = 1; i < np->get_children().size(); ++i) {\
 			const node_ptr& child = np->get_children()[i];\
 			if (\
+				child->is_node_operation() &&\
+				std::get<node_operation>(child->get_value()) == node_operation::param &&\
+				is_read_only_param(np->get_children()[0], i-1, context) &&\
+				(child->get_children()[0]->is_lvalue() || is_constant_variable(child->get_children()[0], context))\
+			) {\
+				const node_ptr& arg = child->get_children()[0];\
+				arguments.push_back(\
+					arg->is_lvalue() ?\
+						expression_builder<lvalue>::build_expression(arg, context) :\
+						build_constant_variable_expression<larray, lvalue>(arg, context)\
+				);\
+			} else if (\
 				child->is_node_operation() &&\
 				std::get<node_operation>(child->get_value()) == node_operation::param\
 			) {\
@@ -778,6 +1021,11 @@ namespace stork {
 				);\
 			}\
 		}\
+		if (int idx = direct_function_index(np->get_children()[0], context); idx >= 0) {\
+			return expression_ptr(\
+				std::make_unique<call_expression<R, T> >(idx, std::move(arguments))\
+			);\
+		}\
 		return expression_ptr(\
 			std::make_unique<call_expression<R, T> >(\
 				expression_builder<function>::build_expression(np->get_children()[0], context),\
@@ -1137,6 +1385,24 @@ namespace stork {
 			lvalue evaluate(runtime_context &context) const override {
 				return std::make_shared<variable_impl<T> >(T{});
 			}
+			
+			bool is_constant() const override {
+				return true;
+			}
+		};
+		
+		class shared_initialization_expression: public expression<lvalue> {
+		private:
+			lvalue _value;
+		public:
+			shared_initialization_expression(lvalue value) :
+				_value(std::move(value))
+			{
+			}
+			
+			lvalue evaluate(runtime_context&) const override {
+				return _value;
+			}
 		};
 	}
 
@@ -1148,6 +1414,10 @@ namespace stork {
 		return build_expression<number>(type_registry::get_number_handle(), context, it, true);
 	}
 	
+	expression<string>::ptr build_string_expression(compiler_context& context, tokens_iterator& it) {
+		return build_expression<string>(type_registry::get_string_handle(), context, it, true);
+	}
+	
 	expression<lvalue>::ptr build_initialization_expression(
 		compiler_context& context,
 		tokens_iterator& it,
@@ -1194,4 +1464,8 @@ namespace stork {
 			}
 		}, *type_id);
 	}
+	
+	expression<lvalue>::ptr build_shared_initialization(lvalue value) {
+		return std::make_unique<shared_initialization_expression>(std::move(value));
+	}
 }
@@ -3,6 +3,7 @@
 
 #include "variable.hpp"
 #include "types.hpp"
+#include "arena.hpp"
 
 #include <string>
 
@@ -12,7 +13,7 @@ namespace stork {
 	class compiler_context;
 
 	template <typename R>
-	class expression {
+	class expression: public arena_allocated {
 		expression(const expression&) = delete;
 		void operator=(const expression&) = delete;
 	protected:
@@ -21,11 +22,17 @@ namespace stork {
 		using ptr = std::unique_ptr<const expression>;
 		
 		virtual R evaluate(runtime_context& context) const = 0;
+		
+		virtual bool is_constant() const {
+			return false;
+		}
+		
 		virtual ~expression() = default;
 	};
 	
 	expression<void>::ptr build_void_expression(compiler_context& context, tokens_iterator& it);
 	expression<number>::ptr build_number_expression(compiler_context& context, tokens_iterator& it);
+	expression<string>::ptr build_string_expression(compiler_context& context, tokens_iterator& it);
 	expression<lvalue>::ptr build_initialization_expression(
 		compiler_context& context,
 		tokens_iterator& it,
@@ -33,6 +40,7 @@ namespace stork {
 		bool allow_comma
 	);
 	expression<lvalue>::ptr build_default_initialization(type_handle type_id);
+	expression<lvalue>::ptr build_shared_initialization(lvalue value);
 }
 
 #endif /* expression_hpp */
@@ -66,11 +66,11 @@ namespace stork {
 				_type_id = number_handle;
 				_lvalue = false;
 			} else if constexpr(std::is_same_v<decltype(value), const identifier&>) {
-				if (const identifier_info* info = context.find(value.name)) {
+				if (const identifier_info* info = context.find(value.id)) {
 					_type_id = info->type_id();
-					_lvalue = (info->get_scope() != identifier_scope::function);
+					_lvalue = (info->get_scope() != identifier_scope::function && !info->is_const());
 				} else {
-					throw undeclared_error(value.name, _line_number, _char_index);
+					throw undeclared_error(std::string(value.name()), _line_number, _char_index);
 				}
 			} else if constexpr(std::is_same_v<decltype(value), const node_operation&>) {
 				switch (value) {
@@ -282,7 +282,7 @@ namespace stork {
 	}
 	
 	std::string_view node::get_identifier() const {
-		return std::get<identifier>(_value).name;
+		return std::get<identifier>(_value).name();
 	}
 	
 	double node::get_number() const {
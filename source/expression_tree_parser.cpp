@@ -206,7 +206,7 @@ namespace stork {
 				case reserved_token::concat_assign:
 					return operator_info(node_operation::concat_assign, line_number, char_index);
 				case reserved_token::mul_assign:
-					return operator_info(node_operation::mod_assign, line_number, char_index);
+					return operator_info(node_operation::mul_assign, line_number, char_index);
 				case reserved_token::div_assign:
 					return operator_info(node_operation::div_assign, line_number, char_index);
 				case reserved_token::idiv_assign:
@@ -459,7 +459,7 @@ namespace stork {
 						);
 					} else if (it->is_string()) {
 						operand_stack.push(std::make_unique<node>(
-							context, it->get_string(), std::vector<node_ptr>(), it->get_line_number(), it->get_char_index())
+							context, std::string(it->get_string()), std::vector<node_ptr>(), it->get_line_number(), it->get_char_index())
 						);
 					} else {
 						operand_stack.push(std::make_unique<node>(
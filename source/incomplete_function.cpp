@@ -3,8 +3,20 @@
 #include "compiler_context.hpp"
 #include "errors.hpp"
 #include "tokenizer.hpp"
+#include "prelexed.hpp"
 
 namespace stork {
+	namespace {
+		uint64_t hash_token(const token& t, uint64_t seed) {
+			seed = hash_bytes(std::string(1, char(t.get_value().index())), seed);
+			if (t.is_number()) {
+				double value = t.get_number();
+				return hash_bytes(std::string_view(reinterpret_cast<const char*>(&value), sizeof(value)), seed);
+			}
+			return hash_bytes(std::to_string(t.get_value()), seed);
+		}
+	}
+	
 	function_declaration parse_function_declaration(compiler_context& ctx, tokens_iterator& it) {
 		function_declaration ret;
 		
@@ -73,11 +85,20 @@ namespace stork {
 		}
 		
 		ctx.create_function(_decl.name, _decl.type_id);
+		
+		_body_hash = hash_bytes(std::to_string(_decl.type_id));
+		for (const std::string& param : _decl.params) {
+			_body_hash = hash_bytes(param, _body_hash);
+		}
+		for (const token& t : _tokens) {
+			_body_hash = hash_token(t, _body_hash);
+		}
 	}
 	
 	incomplete_function::incomplete_function(incomplete_function&& orig) noexcept:
+		_decl(std::move(orig._decl)),
 		_tokens(std::move(orig._tokens)),
-		_decl(std::move(orig._decl))
+		_body_hash(orig._body_hash)
 	{
 	}
 	
@@ -85,6 +106,10 @@ namespace stork {
 		return _decl;
 	}
 	
+	uint64_t incomplete_function::body_hash() const {
+		return _body_hash;
+	}
+	
 	function incomplete_function::compile(compiler_context& ctx) {
 		auto _ = ctx.function();
 		
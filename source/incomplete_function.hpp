@@ -5,6 +5,7 @@
 #include "types.hpp"
 #include <deque>
 #include <functional>
+#include <cstdint>
 
 namespace stork {
 	class compiler_context;
@@ -24,7 +25,7 @@ namespace stork {
 	private:
 		function_declaration _decl;
 		std::deque<token> _tokens;
-		size_t _index;
+		uint64_t _body_hash;
 	public:
 		incomplete_function(compiler_context& ctx, tokens_iterator& it);
 		
@@ -32,6 +33,8 @@ namespace stork {
 		
 		const function_declaration& get_decl() const;
 		
+		uint64_t body_hash() const;
+		
 		function compile(compiler_context& ctx);
 	};
 }
@@ -1,10 +1,14 @@
 #include "module.hpp"
 #include <vector>
 #include <cstdio>
+#include <optional>
+#include <algorithm>
 #include "errors.hpp"
 #include "push_back_stream.hpp"
 #include "tokenizer.hpp"
 #include "compiler.hpp"
+#include "prelexed.hpp"
+#include "token_cache.hpp"
 
 namespace stork {
 	namespace {
@@ -28,69 +32,309 @@ namespace stork {
 				}
 			}
 			
-			int operator()() {
-				return fgetc(_fp);
+			std::string read() {
+				std::string ret;
+				char buffer[65536];
+				while (size_t count = fread(buffer, 1, sizeof(buffer), _fp)) {
+					ret.append(buffer, count);
+				}
+				return ret;
+			}
+		};
+		
+		class source_set {
+		private:
+			struct range {
+				std::string_view name;
+				size_t begin;
+				size_t end;
+				size_t line_number;
+			};
+			
+			std::string _text;
+			std::vector<range> _ranges;
+		public:
+			source_set(std::span<const script_source> sources) {
+				size_t line_number = 0;
+				for (const script_source& source : sources) {
+					if (!_ranges.empty()) {
+						_text.push_back('\n');
+						++line_number;
+					}
+					_ranges.push_back(range{source.name, _text.size(), _text.size() + source.text.size(), line_number});
+					_text.append(source.text);
+					line_number += std::count(source.text.begin(), source.text.end(), '\n');
+				}
+			}
+			
+			std::vector<push_back_stream> streams() const {
+				std::vector<push_back_stream> ret;
+				for (const range& r : _ranges) {
+					ret.emplace_back(std::string_view(_text).substr(0, r.end), r.begin, r.line_number);
+				}
+				if (ret.empty()) {
+					ret.emplace_back(std::string_view());
+				}
+				return ret;
+			}
+			
+			void format_error(const error& err, std::ostream& output) const {
+				auto it = std::upper_bound(
+					_ranges.begin(),
+					_ranges.end(),
+					err.char_index(),
+					[](size_t char_index, const range& r) {
+						return char_index < r.begin;
+					}
+				);
+				
+				if (it == _ranges.begin()) {
+					output << err.what() << std::endl;
+					return;
+				}
+				--it;
+				
+				output << it->name;
+				stork::format_error(
+					error(err.what(), err.line_number() - it->line_number, err.char_index() - it->begin),
+					std::string_view(_text).substr(it->begin, it->end - it->begin),
+					output
+				);
 			}
 		};
 	}
 
 	class module_impl {
 	private:
-		std::vector<std::pair<std::string, function> > _external_functions;
-		std::vector<std::string> _public_declarations;
+		struct program {
+			std::unique_ptr<runtime_context> context;
+			program_layout layout;
+			std::shared_ptr<lazy_functions> lazy;
+			std::vector<std::pair<std::shared_ptr<function>, function> > public_functions;
+		};
+		
+		std::vector<external_function> _external_functions;
+		std::vector<std::pair<std::string, type_factory> > _public_declarations;
+		std::vector<host_global> _host_globals;
 		std::unordered_map<std::string, std::shared_ptr<function> > _public_functions;
 		std::unique_ptr<runtime_context> _context;
+		std::optional<uint64_t> _random_seed;
+		std::optional<size_t> _operation_budget;
+		std::optional<std::chrono::steady_clock::time_point> _deadline;
+		std::optional<size_t> _task_stack_size;
+		std::unique_ptr<token_cache> _cache;
+		bool _lazy_compilation;
+		bool _arena_allocation;
+		std::shared_ptr<lazy_functions> _lazy;
+		program_layout _layout;
+		std::optional<program> _pending;
+		size_t _call_depth;
+		
+		void install(program& p) {
+			_context = std::move(p.context);
+			_layout = std::move(p.layout);
+			_lazy = std::move(p.lazy);
+			
+			for (auto& f : p.public_functions) {
+				f.first->swap(f.second);
+			}
+		}
+		
+		template<typename F>
+		void for_each_context(F f) {
+			if (_context) {
+				f(*_context);
+			}
+			if (_pending) {
+				f(*_pending->context);
+			}
+		}
 	public:
-		module_impl(){
+		module_impl():
+			_lazy_compilation(false),
+			_arena_allocation(true),
+			_call_depth(0)
+		{
 		}
 		
-		runtime_context* get_runtime_context() {
-			return _context.get();
+		runtime_context& enter_call() {
+			runtime_assertion(_context != nullptr, "Module is not loaded");
+			++_call_depth;
+			return *_context;
 		}
 		
-		void add_public_function_declaration(std::string declaration, std::string name, std::shared_ptr<function> fptr) {
-			_public_declarations.push_back(std::move(declaration));
+		void leave_call() {
+			if (--_call_depth == 0 && _pending) {
+				program p = std::move(*_pending);
+				_pending.reset();
+				install(p);
+			}
+		}
+		
+		void add_public_function_declaration(std::string name, type_factory type, std::shared_ptr<function> fptr) {
+			_public_declarations.emplace_back(name, type);
 			_public_functions.emplace(std::move(name), std::move(fptr));
 		}
 		
-		void add_external_function_impl(std::string declaration, function f) {
-			_external_functions.emplace_back(std::move(declaration), std::move(f));
+		void add_external_function_impl(std::string name, type_factory type, function f, bool pure, std::vector<bool> read_only_params) {
+			_external_functions.push_back(external_function{std::move(name), type, std::string(), std::move(f), pure, std::move(read_only_params)});
 		}
 		
-		void load(const char* path) {
-			file f(path);
-			get_character get = [&](){
-				return f();
-			};
-			push_back_stream stream(&get);
+		void add_host_global(std::string name, type_factory type, variable_ptr value) {
+			_host_globals.push_back(host_global{std::move(name), type, std::move(value)});
+		}
+		
+		void add_native_function(std::string declaration, function f) {
+			_external_functions.push_back(external_function{std::string(), nullptr, std::move(declaration), std::move(f), false, {}});
+		}
+		
+		void load_streams(std::span<push_back_stream> streams, bool reload = false) {
+			tokens_iterator it(streams);
+			load_tokens(it, reload);
+		}
+		
+		void load_tokens(tokens_iterator& it, bool reload = false) {
+			runtime_context* current = _pending ? _pending->context.get() : _context.get();
+			const program_layout& current_layout = _pending ? _pending->layout : _layout;
+			
+			program p;
+			
+			compile_options options;
+			options.lazy = _lazy_compilation ? &p.lazy : nullptr;
+			options.previous = (reload && current) ? &current_layout : nullptr;
+			options.layout = &p.layout;
+			options.node_arenas = _arena_allocation;
+			
+			auto context = std::make_unique<runtime_context>(compile(
+				it, _external_functions, _public_declarations, _host_globals, options
+			));
+			
+			const program_layout& layout = p.layout;
 			
-			tokens_iterator it(stream);
+			if (options.previous) {
+				std::unordered_map<std::string, size_t> old_globals;
+				for (size_t i = 0; i < current_layout.globals.size(); ++i) {
+					if (!current_layout.shared[i]) {
+						old_globals.emplace(current_layout.globals[i], i);
+					}
+				}
+				
+				for (size_t i = 0; i < layout.globals.size(); ++i) {
+					auto old = old_globals.find(layout.globals[i]);
+					if (!layout.shared[i] && old != old_globals.end()) {
+						context->global(int(i)) = current->global(int(old->second));
+					}
+				}
+				
+				context->random() = current->random();
+			} else if (_random_seed) {
+				context->random().seed(*_random_seed);
+			}
 			
-			_context = std::make_unique<runtime_context>(compile(it, _external_functions, _public_declarations));
+			if (_operation_budget) {
+				context->set_operation_budget(*_operation_budget);
+			}
+			if (_deadline) {
+				context->set_deadline(*_deadline);
+			}
+			if (_task_stack_size) {
+				context->set_task_stack_size(*_task_stack_size);
+			}
 			
-			for (const auto& p : _public_functions) {
-				*p.second = _context->get_public_function(p.first.c_str());
+			for (const auto& f : _public_functions) {
+				p.public_functions.emplace_back(f.second, context->get_public_function(f.first.c_str()));
+			}
+			p.context = std::move(context);
+			
+			if (_call_depth > 0) {
+				_pending = std::move(p);
+			} else {
+				install(p);
 			}
 		}
 		
-		bool try_load(const char* path, std::ostream* err) noexcept{
+		std::string cache_environment() const {
+			compiler_context ctx;
+			std::string ret;
+			for (const external_function& f : _external_functions) {
+				ret += f.type ? f.name + " " + std::to_string(f.type(ctx)) : f.declaration;
+				ret += '\n';
+			}
+			for (const auto& d : _public_declarations) {
+				ret += "public " + d.first + " " + std::to_string(d.second(ctx)) + '\n';
+			}
+			for (const host_global& g : _host_globals) {
+				ret += "global " + g.name + " " + std::to_string(g.type(ctx)) + '\n';
+			}
+			return ret;
+		}
+		
+		void load_source(std::string_view source, bool reload = false) {
+			if (_cache) {
+				std::deque<token> tokens = _cache->get(source, cache_environment());
+				tokens_iterator it(tokens);
+				load_tokens(it, reload);
+			} else {
+				push_back_stream stream(source);
+				load_streams(std::span<push_back_stream>(&stream, 1), reload);
+			}
+		}
+		
+		void load_sources(std::span<const script_source> sources) {
+			source_set set(sources);
+			std::vector<push_back_stream> streams = set.streams();
+			load_streams(streams);
+		}
+		
+		void load(const char* path, bool reload = false) {
+			load_source(file(path).read(), reload);
+		}
+		
+		bool try_load_source(std::string_view source, std::ostream* err, bool reload = false) noexcept{
 			try {
-				load(path);
+				load_source(source, reload);
 				return true;
-			} catch(const file_not_found& e) {
+			} catch(const error& e) {
+				if (err) {
+					format_error(e, source, *err);
+				}
+			} catch(const runtime_error& e) {
+				if (err) {
+					*err << e.what() << std::endl;
+				}
+			}
+			return false;
+		}
+		
+		bool try_load_sources(std::span<const script_source> sources, std::ostream* err) noexcept{
+			try {
+				load_sources(sources);
+				return true;
+			} catch(const error& e) {
+				if (err) {
+					source_set(sources).format_error(e, *err);
+				}
+			} catch(const runtime_error& e) {
 				if (err) {
 					*err << e.what() << std::endl;
 				}
+			}
+			return false;
+		}
+		
+		void load_prelexed(std::string_view data) {
+			std::deque<token> tokens = read_prelexed(data);
+			tokens_iterator it(tokens);
+			load_tokens(it);
+		}
+		
+		bool try_load_prelexed(std::string_view data, std::ostream* err) noexcept{
+			try {
+				load_prelexed(data);
+				return true;
 			} catch(const error& e) {
 				if (err) {
-					file f(path);
-					format_error(
-						e,
-						[&](){
-							return f();
-						},
-						*err
-					);
+					*err << "(" << (e.line_number() + 1) << ") " << e.what() << std::endl;
 				}
 			} catch(const runtime_error& e) {
 				if (err) {
@@ -100,10 +344,85 @@ namespace stork {
 			return false;
 		}
 		
+		bool try_load(const char* path, std::ostream* err, bool reload = false) noexcept{
+			std::string source;
+			try {
+				source = file(path).read();
+			} catch(const file_not_found& e) {
+				if (err) {
+					*err << e.what() << std::endl;
+				}
+				return false;
+			}
+			return try_load_source(source, err, reload);
+		}
+		
 		void reset_globals() {
-			if (_context) {
-				_context->initialize();
+			for_each_context([](runtime_context& ctx) {
+				ctx.initialize();
+			});
+		}
+		
+		void set_operation_budget(size_t operations) {
+			_operation_budget = operations;
+			for_each_context([operations](runtime_context& ctx) {
+				ctx.set_operation_budget(operations);
+			});
+		}
+		
+		void set_deadline(std::chrono::steady_clock::time_point deadline) {
+			_deadline = deadline;
+			for_each_context([deadline](runtime_context& ctx) {
+				ctx.set_deadline(deadline);
+			});
+		}
+		
+		void clear_budget() {
+			_operation_budget.reset();
+			_deadline.reset();
+			for_each_context([](runtime_context& ctx) {
+				ctx.clear_budget();
+			});
+		}
+		
+		void set_task_stack_size(size_t stack_size) {
+			_task_stack_size = stack_size;
+			for_each_context([stack_size](runtime_context& ctx) {
+				ctx.set_task_stack_size(stack_size);
+			});
+		}
+		
+		void set_lazy_compilation(bool lazy) {
+			_lazy_compilation = lazy;
+		}
+		
+		void compile_all() {
+			if (_lazy) {
+				stork::compile_all(*_lazy);
+			}
+		}
+		
+		void set_arena_allocation(bool arena) {
+			_arena_allocation = arena;
+		}
+		
+		size_t compiled_bytes() {
+			size_t ret = _lazy ? node_bytes(*_lazy) : 0;
+			for (size_t bytes : _layout.node_bytes) {
+				ret += bytes;
 			}
+			return ret;
+		}
+		
+		void set_cache_directory(const char* path, size_t max_size) {
+			_cache = std::make_unique<token_cache>(path, max_size);
+		}
+		
+		void set_random_seed(uint64_t seed) {
+			_random_seed = seed;
+			for_each_context([seed](runtime_context& ctx) {
+				ctx.random().seed(seed);
+			});
 		}
 	};
 	
@@ -112,16 +431,30 @@ namespace stork {
 	{
 	}
 	
-	runtime_context* stork_module::get_runtime_context() {
-		return _impl->get_runtime_context();
+	stork_module::call_scope::call_scope(stork_module& m):
+		_impl(*m._impl),
+		_context(_impl.enter_call())
+	{
+	}
+	
+	stork_module::call_scope::~call_scope() {
+		_impl.leave_call();
 	}
 	
-	void stork_module::add_external_function_impl(std::string declaration, function f) {
-		_impl->add_external_function_impl(std::move(declaration), std::move(f));
+	void stork_module::add_external_function_impl(std::string name, type_factory type, function f, bool pure, std::vector<bool> read_only_params) {
+		_impl->add_external_function_impl(std::move(name), type, std::move(f), pure, std::move(read_only_params));
 	}
 
-	void stork_module::add_public_function_declaration(std::string declaration, std::string name, std::shared_ptr<function> fptr) {
-		_impl->add_public_function_declaration(std::move(declaration), std::move(name), std::move(fptr));
+	void stork_module::add_native_function(std::string declaration, function f) {
+		_impl->add_native_function(std::move(declaration), std::move(f));
+	}
+	
+	void stork_module::add_public_function_declaration(std::string name, type_factory type, std::shared_ptr<function> fptr) {
+		_impl->add_public_function_declaration(std::move(name), type, std::move(fptr));
+	}
+	
+	void stork_module::add_host_global(std::string name, type_factory type, variable_ptr value) {
+		_impl->add_host_global(std::move(name), type, std::move(value));
 	}
 	
 	void stork_module::load(const char* path) {
@@ -132,10 +465,90 @@ namespace stork {
 		return _impl->try_load(path, err);
 	}
 	
+	void stork_module::reload(const char* path) {
+		_impl->load(path, true);
+	}
+	
+	bool stork_module::try_reload(const char* path, std::ostream* err) noexcept{
+		return _impl->try_load(path, err, true);
+	}
+	
+	void stork_module::reload_source(std::string_view source) {
+		_impl->load_source(source, true);
+	}
+	
+	bool stork_module::try_reload_source(std::string_view source, std::ostream* err) noexcept{
+		return _impl->try_load_source(source, err, true);
+	}
+	
+	void stork_module::load_source(std::string_view source) {
+		_impl->load_source(source);
+	}
+	
+	bool stork_module::try_load_source(std::string_view source, std::ostream* err) noexcept{
+		return _impl->try_load_source(source, err);
+	}
+	
+	void stork_module::load_prelexed(std::string_view data) {
+		_impl->load_prelexed(data);
+	}
+	
+	bool stork_module::try_load_prelexed(std::string_view data, std::ostream* err) noexcept{
+		return _impl->try_load_prelexed(data, err);
+	}
+	
+	void stork_module::load_sources(std::span<const script_source> sources) {
+		_impl->load_sources(sources);
+	}
+	
+	bool stork_module::try_load_sources(std::span<const script_source> sources, std::ostream* err) noexcept{
+		return _impl->try_load_sources(sources, err);
+	}
+	
 	void stork_module::reset_globals() {
 		_impl->reset_globals();
 	}
 	
+	void stork_module::set_operation_budget(size_t operations) {
+		_impl->set_operation_budget(operations);
+	}
+	
+	void stork_module::set_deadline(std::chrono::steady_clock::time_point deadline) {
+		_impl->set_deadline(deadline);
+	}
+	
+	void stork_module::clear_budget() {
+		_impl->clear_budget();
+	}
+	
+	void stork_module::set_task_stack_size(size_t stack_size) {
+		_impl->set_task_stack_size(stack_size);
+	}
+	
+	void stork_module::set_lazy_compilation(bool lazy) {
+		_impl->set_lazy_compilation(lazy);
+	}
+	
+	void stork_module::compile_all() {
+		_impl->compile_all();
+	}
+	
+	void stork_module::set_arena_allocation(bool arena) {
+		_impl->set_arena_allocation(arena);
+	}
+	
+	size_t stork_module::compiled_bytes() const {
+		return _impl->compiled_bytes();
+	}
+	
+	void stork_module::set_cache_directory(const char* path, size_t max_size) {
+		_impl->set_cache_directory(path, max_size);
+	}
+	
+	void stork_module::set_random_seed(uint64_t seed) {
+		_impl->set_random_seed(seed);
+	}
+	
 	stork_module::~stork_module() {
 	}
 }
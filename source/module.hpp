@@ -5,24 +5,252 @@
 #include <tuple>
 #include <type_traits>
 #include <utility>
+#include <string_view>
 #include <iostream>
+#include <chrono>
+#include <span>
+#include <thread>
+#include <exception>
+#include <algorithm>
+#include <vector>
+#include <array>
+#include <map>
+#include <list>
+#include <bit>
+#include <cstdint>
+#include <mutex>
 #include "variable.hpp"
 #include "runtime_context.hpp"
+#include "compiler_context.hpp"
+#include "errors.hpp"
 
 namespace stork {
 	namespace details {
+		inline variable_ptr to_variable(number n) {
+			return std::make_shared<variable_impl<number> >(n);
+		}
+		
+		inline variable_ptr to_variable(std::string str) {
+			return std::make_shared<variable_impl<string> >(std::make_shared<std::string>(std::move(str)));
+		}
+		
+		inline variable_ptr to_variable(std::string_view str) {
+			return std::make_shared<variable_impl<string> >(std::make_shared<std::string>(str));
+		}
+		
+		inline variable_ptr to_variable(string str) {
+			return std::make_shared<variable_impl<string> >(std::move(str));
+		}
+		
+		inline number& number_value(const variable_ptr& v) {
+			return static_cast<variable_impl<number>&>(*v).value;
+		}
+		
+		inline variable_ptr to_variable(std::span<const number> numbers) {
+			array arr;
+			for (number n : numbers) {
+				arr.push_back(std::make_shared<variable_impl<number> >(n));
+			}
+			return std::make_shared<variable_impl<array> >(std::move(arr));
+		}
+		
+		template <typename T>
+		T move_from_variable(const variable_ptr& v) {
+			if constexpr (std::is_same<T, std::vector<number> >::value) {
+				const array& arr = v->static_pointer_downcast<larray>()->value;
+				std::vector<number> ret;
+				ret.reserve(arr.size());
+				for (const variable_ptr& element : arr) {
+					ret.push_back(number_value(element));
+				}
+				return ret;
+			} else if constexpr (std::is_same<T, string>::value) {
+				return std::move(static_cast<variable_impl<string>&>(*v).value);
+			} else if constexpr (std::is_same<T, std::string>::value) {
+				string& str = static_cast<variable_impl<string>&>(*v).value;
+				if (str.use_count() == 1) {
+					return std::move(*str);
+				}
+				return *str;
+			} else {
+				static_assert(std::is_same<number, T>::value);
+				return number_value(v);
+			}
+		}
+	}
+	
+	template<typename Signature>
+	class script_function;
+	
+	template<typename R, typename... Args>
+	class script_function<R(Args...)> {
+	private:
+		function _f;
+	public:
+		script_function(function f):
+			_f(std::move(f))
+		{
+		}
+		
+		const function& get() const {
+			return _f;
+		}
+		
+		R operator()(runtime_context& ctx, Args... args) const {
+			if constexpr(std::is_same<R, void>::value) {
+				ctx.call(_f, {details::to_variable(std::move(args))...});
+			} else {
+				return details::move_from_variable<R>(ctx.call(_f, {details::to_variable(std::move(args))...}));
+			}
+		}
+	};
+	
+	namespace details {
+		inline std::vector<std::vector<number> >& array_buffer_pool() {
+			thread_local std::vector<std::vector<number> > pool;
+			return pool;
+		}
+		
+		template<typename T>
+		class array_argument {
+		private:
+			larray _arr;
+			std::vector<number> _buffer;
+		public:
+			explicit array_argument(larray arr):
+				_arr(std::move(arr))
+			{
+				std::vector<std::vector<number> >& pool = array_buffer_pool();
+				if (!pool.empty()) {
+					_buffer = std::move(pool.back());
+					pool.pop_back();
+				}
+				
+				_buffer.clear();
+				_buffer.reserve(_arr->value.size());
+				for (const variable_ptr& v : _arr->value) {
+					_buffer.push_back(number_value(v));
+				}
+			}
+			
+			array_argument(array_argument&& oth) noexcept = default;
+			
+			operator std::span<T>() {
+				return _buffer;
+			}
+			
+			~array_argument() {
+				if (!_arr) {
+					return;
+				}
+				
+				if constexpr(!std::is_const<T>::value) {
+					for (size_t i = 0; i < _buffer.size() && i < _arr->value.size(); ++i) {
+						number_value(_arr->value[i]) = _buffer[i];
+					}
+				}
+				
+				array_buffer_pool().push_back(std::move(_buffer));
+			}
+		};
+		
+		template<typename T>
+		struct is_number_span {
+			static const bool value = false;
+		};
+		
+		template<>
+		struct is_number_span<std::span<const number> > {
+			static const bool value = true;
+		};
+		
+		template<>
+		struct is_number_span<std::span<number> > {
+			static const bool value = true;
+		};
+		
+		template<typename T>
+		struct is_read_only_argument {
+			static const bool value =
+				std::is_same<std::decay_t<T>, std::span<const number> >::value ||
+				std::is_same<std::decay_t<T>, std::vector<number> >::value;
+		};
+		
+		template<typename T>
+		struct is_script_function {
+			static const bool value = false;
+		};
+		
+		template<typename Signature>
+		struct is_script_function<script_function<Signature> > {
+			static const bool value = true;
+		};
+		
 		template<typename R, typename Unpacked, typename Left>
 		struct unpacker;
 		
 		template<typename R, typename... Unpacked, typename Left0, typename... Left>
 		struct unpacker<R, std::tuple<Unpacked...>, std::tuple<Left0, Left...> >{
+			template<typename F>
 			R operator()(
 				runtime_context& ctx,
-				const std::function<R(Unpacked..., Left0, Left...)>& f,
+				const F& f,
 				std::tuple<Unpacked...> t
 			) const {
 				using next_unpacker = unpacker<R, std::tuple<Unpacked..., Left0>, std::tuple<Left...> >;
-				if constexpr(std::is_convertible<const std::string&, Left0>::value) {
+				if constexpr(is_script_function<std::decay_t<Left0> >::value) {
+					return next_unpacker()(
+						ctx,
+						f,
+						std::tuple_cat(
+							std::move(t),
+							std::tuple<Left0>(
+								ctx.local(
+									-1 - int(sizeof...(Unpacked))
+								)->static_pointer_downcast<lfunction>()->value
+							)
+						)
+					);
+				} else if constexpr(is_number_span<std::decay_t<Left0> >::value) {
+					return next_unpacker()(
+						ctx,
+						f,
+						std::tuple_cat(
+							std::move(t),
+							std::tuple<array_argument<typename std::decay_t<Left0>::element_type> >(
+								ctx.local(
+									-1 - int(sizeof...(Unpacked))
+								)->static_pointer_downcast<larray>()
+							)
+						)
+					);
+				} else if constexpr(std::is_same<std::decay_t<Left0>, std::vector<number> >::value) {
+					return next_unpacker()(
+						ctx,
+						f,
+						std::tuple_cat(
+							std::move(t),
+							std::tuple<std::vector<number> >(
+								move_from_variable<std::vector<number> >(ctx.local(
+									-1 - int(sizeof...(Unpacked))
+								))
+							)
+						)
+					);
+				} else if constexpr(std::is_same<std::decay_t<Left0>, string>::value) {
+					return next_unpacker()(
+						ctx,
+						f,
+						std::tuple_cat(
+							std::move(t),
+							std::tuple<Left0>(
+								ctx.local(
+									-1 - int(sizeof...(Unpacked))
+								)->static_pointer_downcast<lstring>()->value
+							)
+						)
+					);
+				} else if constexpr(std::is_convertible<const std::string&, Left0>::value) {
 					return next_unpacker()(
 						ctx,
 						f,
@@ -55,24 +283,108 @@ namespace stork {
 	
 		template<typename R, typename... Unpacked>
 		struct unpacker<R, std::tuple<Unpacked...>, std::tuple<> >{
+			template<typename F>
 			R operator()(
-				runtime_context& ctx,
-				const std::function<R(Unpacked...)>& f,
+				runtime_context&,
+				const F& f,
 				std::tuple<Unpacked...> t
 			) const {
-				return std::apply(f, t);
+				return std::apply(f, std::move(t));
 			}
 		};
 		
+		constexpr size_t memo_capacity = 4096;
+		
+		inline uint64_t memo_key_value(number n) {
+			return std::bit_cast<uint64_t>(n);
+		}
+		
+		inline std::string memo_key_value(std::string_view str) {
+			return std::string(str);
+		}
+		
+		inline std::string memo_key_value(const string& str) {
+			return *str;
+		}
+		
+		template<typename T>
+		struct is_memo_key {
+			static const bool value =
+				std::is_arithmetic<std::decay_t<T> >::value ||
+				std::is_same<std::decay_t<T>, string>::value ||
+				std::is_convertible<const std::decay_t<T>&, std::string_view>::value;
+		};
+		
+		template<typename R>
+		struct is_memo_result {
+			static const bool value =
+				std::is_arithmetic<R>::value ||
+				std::is_same<R, string>::value ||
+				std::is_same<R, std::string>::value ||
+				std::is_same<R, std::vector<number> >::value;
+		};
+		
 		template<typename R, typename... Args>
-		function create_external_function(std::function<R(Args...)> f) {
+		struct is_memoizable {
+			static const bool value = is_memo_result<R>::value && (is_memo_key<Args>::value && ...);
+		};
+		
+		template<typename R, typename... Args, typename F>
+		auto memoize(F f) {
+			using key = std::tuple<decltype(memo_key_value(std::declval<const std::decay_t<Args>&>()))...>;
+			
+			struct cache {
+				std::mutex mutex;
+				std::list<std::pair<key, R> > entries;
+				std::map<key, typename std::list<std::pair<key, R> >::iterator> index;
+			};
+			
+			return [f=std::move(f), c=std::make_shared<cache>()](runtime_context& ctx, Args... args) -> R {
+				key k(memo_key_value(args)...);
+				
+				{
+					std::lock_guard<std::mutex> lock(c->mutex);
+					if (auto it = c->index.find(k); it != c->index.end()) {
+						c->entries.splice(c->entries.begin(), c->entries, it->second);
+						return it->second->second;
+					}
+				}
+				
+				R ret = f(ctx, std::forward<Args>(args)...);
+				
+				std::lock_guard<std::mutex> lock(c->mutex);
+				if (c->index.find(k) == c->index.end()) {
+					if (c->entries.size() >= memo_capacity) {
+						c->index.erase(c->entries.back().first);
+						c->entries.pop_back();
+					}
+					c->entries.emplace_front(k, ret);
+					c->index.emplace(std::move(k), c->entries.begin());
+				}
+				
+				return ret;
+			};
+		}
+		
+		template<typename R, typename... Args, typename F>
+		function create_external_function(F f) {
 			return [f=std::move(f)](runtime_context& ctx) {
+				auto bound = [&](auto&&... args) -> R {
+					return f(ctx, std::forward<decltype(args)>(args)...);
+				};
+				
 				if constexpr(std::is_same<R, void>::value) {
-					unpacker<R, std::tuple<>, std::tuple<Args...> >()(ctx, f, std::tuple<>());
+					unpacker<R, std::tuple<>, std::tuple<Args...> >()(ctx, bound, std::tuple<>());
 				} else {
-					R retval = unpacker<R, std::tuple<>, std::tuple<Args...> >()(ctx, f, std::tuple<>());
-					if constexpr(std::is_convertible<R, std::string>::value) {
+					R retval = unpacker<R, std::tuple<>, std::tuple<Args...> >()(ctx, bound, std::tuple<>());
+					if constexpr(std::is_same<R, std::vector<number> >::value) {
+						ctx.retval() = to_variable(std::span<const number>(retval));
+					} else if constexpr(std::is_same<R, string>::value) {
+						ctx.retval() = std::make_shared<variable_impl<string> >(std::move(retval));
+					} else if constexpr(std::is_convertible<R, std::string>::value) {
 						ctx.retval() = std::make_shared<variable_impl<string> >(std::make_shared<std::string>(std::move(retval)));
+					} else if constexpr(std::is_convertible<R, std::string_view>::value) {
+						ctx.retval() = std::make_shared<variable_impl<string> >(std::make_shared<std::string>(std::string_view(retval)));
 					} else {
 						static_assert(std::is_convertible<R, number>::value);
 						ctx.retval() = std::make_shared<variable_impl<number> >(retval);
@@ -81,124 +393,534 @@ namespace stork {
 			};
 		}
 		
+		inline type_handle number_array_type(compiler_context& ctx) {
+			return ctx.get_handle(array_type{type_registry::get_number_handle()});
+		}
+		
 		template<typename T>
-		struct retval_declaration{
-			static constexpr const char* result() {
+		struct retval_type{
+			static type_handle get(compiler_context& ctx) {
 				if constexpr(std::is_same<T, void>::value) {
-					return "void";
-				} else if constexpr(std::is_convertible<T, std::string>::value) {
-					return "string";
+					return type_registry::get_void_handle();
+				} else if constexpr(std::is_same<T, std::vector<number> >::value) {
+					return number_array_type(ctx);
+				} else if constexpr(
+					std::is_same<T, string>::value ||
+					std::is_convertible<T, std::string>::value ||
+					std::is_convertible<T, std::string_view>::value
+				) {
+					return type_registry::get_string_handle();
 				} else {
 					static_assert(std::is_convertible<T, number>::value);
-					return "number";
+					return type_registry::get_number_handle();
 				}
 			}
 		};
 		
 		template<typename T>
-		struct argument_declaration{
-			static constexpr const char* result() {
-				if constexpr(std::is_convertible<const std::string&, T>::value) {
-					return "string";
+		struct argument_type;
+		
+		template<typename R, typename... Args>
+		type_handle create_function_type(compiler_context& ctx) {
+			return ctx.get_handle(function_type{
+				retval_type<R>::get(ctx),
+				{argument_type<Args>::get(ctx)...}
+			});
+		}
+		
+		template<typename T>
+		struct argument_type{
+			static function_type::param get(compiler_context& ctx) {
+				if constexpr(is_script_function<std::decay_t<T> >::value) {
+					return argument_type<std::decay_t<T> >::get(ctx);
+				} else if constexpr(
+					std::is_same<std::decay_t<T>, std::span<const number> >::value ||
+					std::is_same<std::decay_t<T>, std::vector<number> >::value
+				) {
+					return {number_array_type(ctx), false};
+				} else if constexpr(std::is_same<std::decay_t<T>, std::span<number> >::value) {
+					return {number_array_type(ctx), true};
+				} else if constexpr(
+					std::is_same<std::decay_t<T>, string>::value ||
+					std::is_convertible<const std::string&, T>::value
+				) {
+					return {type_registry::get_string_handle(), false};
 				} else {
 					static_assert(std::is_convertible<number, T>::value);
-					return "number";
+					return {type_registry::get_number_handle(), false};
 				}
 			}
 		};
 		
-		struct function_argument_string{
-			std::string str;
-			function_argument_string(const char* p):
-				str(p)
-			{
+		template<typename R, typename... Args>
+		struct argument_type<script_function<R(Args...)> >{
+			static function_type::param get(compiler_context& ctx) {
+				return {create_function_type<R, Args...>(ctx), false};
+			}
+		};
+		
+		template <typename T>
+		auto create_box() {
+			if constexpr (std::is_same<T, std::vector<number> >::value) {
+				return std::make_shared<variable_impl<array> >(array());
+			} else if constexpr (std::is_same<T, std::string>::value) {
+				return std::make_shared<variable_impl<string> >(std::make_shared<std::string>());
+			} else {
+				static_assert(std::is_same<number, T>::value);
+				return std::make_shared<variable_impl<number> >(0);
 			}
+		}
+		
+		inline void assign_box(const lnumber& box, number n) {
+			box->value = n;
+		}
+		
+		inline void assign_box(const lstring& box, const std::string& str) {
+			if (box->value.use_count() == 1) {
+				*box->value = str;
+			} else {
+				box->value = std::make_shared<std::string>(str);
+			}
+		}
+		
+		template<typename T>
+		struct is_direct_type {
+			static const bool value = std::is_same<T, number>::value || std::is_same<T, std::string>::value;
+		};
+		
+		template<typename R, typename... Args>
+		void call_rows(
+			runtime_context& ctx,
+			const function& f,
+			size_t begin,
+			size_t end,
+			R* results,
+			const Args*... columns
+		) {
+			auto boxes = std::make_tuple(create_box<Args>()...);
+			
+			variable_ptr retval;
+			if constexpr(is_direct_type<R>::value) {
+				retval = create_box<R>();
+			}
+			
+			auto frame = ctx.enter_frame(std::apply(
+				[](const auto&... box) {
+					return std::vector<variable_ptr>{box...};
+				},
+				boxes
+			));
+			
+			for (size_t row = begin; row < end; ++row) {
+				std::apply(
+					[&](const auto&... box) {
+						(assign_box(box, columns[row]), ...);
+					},
+					boxes
+				);
+				
+				if constexpr(std::is_same<R, void>::value) {
+					frame.call(f);
+				} else {
+					results[row] = move_from_variable<R>(frame.call(f, retval));
+				}
+			}
+		}
+		
+		template<typename R, typename... Args>
+		void call_batch(
+			runtime_context& ctx,
+			const function& f,
+			size_t rows,
+			size_t threads,
+			R* results,
+			const Args*... columns
+		) {
+			threads = std::max<size_t>(1, std::min(threads, rows));
 			
-			function_argument_string& operator+=(const function_argument_string& oth) {
-				str += ", ";
-				str += oth.str;
-				return *this;
+			if (threads == 1) {
+				call_rows(ctx, f, 0, rows, results, columns...);
+				return;
 			}
+			
+			size_t shard = (rows + threads - 1) / threads;
+			
+			std::vector<runtime_context> contexts;
+			contexts.reserve(threads - 1);
+			for (size_t i = 1; i < threads; ++i) {
+				contexts.push_back(ctx.fork());
+			}
+			
+			std::vector<std::exception_ptr> errors(threads);
+			std::vector<std::thread> workers;
+			workers.reserve(threads - 1);
+			
+			for (size_t i = 1; i < threads; ++i) {
+				workers.emplace_back([&, i]() {
+					try {
+						call_rows(contexts[i-1], f, std::min(rows, i * shard), std::min(rows, (i + 1) * shard), results, columns...);
+					} catch (...) {
+						errors[i] = std::current_exception();
+					}
+				});
+			}
+			
+			try {
+				call_rows(ctx, f, 0, std::min(rows, shard), results, columns...);
+			} catch (...) {
+				errors[0] = std::current_exception();
+			}
+			
+			for (std::thread& worker : workers) {
+				worker.join();
+			}
+			
+			for (const std::exception_ptr& e : errors) {
+				if (e) {
+					std::rethrow_exception(e);
+				}
+			}
+		}
+	}
+	
+	namespace details {
+		template<typename R, typename... Args>
+		struct is_direct_callable {
+			static const bool value =
+				(std::is_same<R, void>::value || is_direct_type<R>::value) &&
+				(is_direct_type<Args>::value && ...);
 		};
 		
 		template<typename R, typename... Args>
-		std::string create_function_declaration(const char* name) {
-			if constexpr(sizeof...(Args) == 0) {
-				return std::string("function ") + retval_declaration<R>::result() + " " + name + "()";
-			} else {
-				return std::string("function ") + retval_declaration<R>::result() + " " + name +
-					"(" +
-					(
-						function_argument_string(argument_declaration<Args>::result()) += ...
-					).str +
-					")";
+		class direct_caller {
+		private:
+			std::tuple<decltype(create_box<Args>())...> _boxes;
+			std::array<variable_ptr, sizeof...(Args)> _params;
+			variable_ptr _retval;
+			string _retval_string;
+			bool _busy;
+			
+			struct busy_guard {
+				bool& busy;
+				
+				~busy_guard() {
+					busy = false;
+				}
+			};
+		public:
+			direct_caller():
+				_boxes(create_box<Args>()...),
+				_params(std::apply(
+					[](const auto&... box) {
+						return std::array<variable_ptr, sizeof...(Args)>{box...};
+					},
+					_boxes
+				)),
+				_busy(false)
+			{
+				if constexpr(std::is_same<R, std::string>::value) {
+					auto box = create_box<R>();
+					_retval_string = box->value;
+					_retval = std::move(box);
+				} else if constexpr(!std::is_same<R, void>::value) {
+					_retval = create_box<R>();
+				}
 			}
+			
+			R operator()(runtime_context& ctx, const function& f, const Args&... args) {
+				if (_busy) {
+					direct_caller nested;
+					return nested(ctx, f, args...);
+				}
+				
+				_busy = true;
+				busy_guard guard{_busy};
+				
+				std::apply(
+					[&](const auto&... box) {
+						(assign_box(box, args), ...);
+					},
+					_boxes
+				);
+				
+				auto frame = ctx.enter_frame(std::span<const variable_ptr>(_params));
+				
+				if constexpr(std::is_same<R, void>::value) {
+					frame.call(f);
+				} else if constexpr(std::is_same<R, std::string>::value) {
+					R ret = move_from_variable<R>(frame.call(f, _retval));
+					static_cast<variable_impl<string>&>(*_retval).value = _retval_string;
+					return ret;
+				} else {
+					return move_from_variable<R>(frame.call(f, _retval));
+				}
+			}
+		};
+	}
+	
+	template<typename T>
+	class global_binding;
+	
+	template<>
+	class global_binding<number> {
+	private:
+		lnumber _var;
+	public:
+		explicit global_binding(lnumber var):
+			_var(std::move(var))
+		{
 		}
 		
-		inline variable_ptr to_variable(number n) {
-			return std::make_shared<variable_impl<number> >(n);
+		number& operator*() const {
+			return _var->value;
+		}
+	};
+	
+	template<>
+	class global_binding<std::string> {
+	private:
+		lstring _var;
+	public:
+		explicit global_binding(lstring var):
+			_var(std::move(var))
+		{
 		}
 		
-		inline variable_ptr to_variable(std::string str) {
-			return std::make_shared<variable_impl<string> >(std::make_shared<std::string>(std::move(str)));
+		const std::string& get() const {
+			return *_var->value;
 		}
 		
-		template <typename T>
-		T move_from_variable(const variable_ptr& v) {
-			if constexpr (std::is_same<T, std::string>::value) {
-				return std::move(*v->static_pointer_downcast<lstring>()->value);
-			} else {
-				static_assert(std::is_same<number, T>::value);
-				return v->static_pointer_downcast<lnumber>()->value;
+		void set(std::string str) {
+			_var->value = std::make_shared<std::string>(std::move(str));
+		}
+	};
+	
+	template<>
+	class global_binding<std::vector<number> > {
+	private:
+		larray _var;
+	public:
+		explicit global_binding(larray var):
+			_var(std::move(var))
+		{
+		}
+		
+		size_t size() const {
+			return _var->value.size();
+		}
+		
+		number& operator[](size_t idx) const {
+			return details::number_value(_var->value[idx]);
+		}
+		
+		void resize(size_t size) {
+			array& arr = _var->value;
+			while (arr.size() > size) {
+				arr.pop_back();
+			}
+			while (arr.size() < size) {
+				arr.push_back(std::make_shared<variable_impl<number> >(0));
 			}
 		}
-	}
+		
+		void assign(std::span<const number> numbers) {
+			resize(numbers.size());
+			for (size_t i = 0; i < numbers.size(); ++i) {
+				details::number_value(_var->value[i]) = numbers[i];
+			}
+		}
+	};
+	
+	enum struct function_purity {
+		impure,
+		pure,
+		memoized,
+	};
 	
 	class module_impl;
 	
+	struct script_source {
+		std::string name;
+		std::string_view text;
+	};
+	
 	class stork_module {
 	private:
 		std::unique_ptr<module_impl> _impl;
-		void add_external_function_impl(std::string declaration, function f);
-		void add_public_function_declaration(std::string declaration, std::string name, std::shared_ptr<function> fptr);
-		runtime_context* get_runtime_context();
+		void add_external_function_impl(std::string name, type_factory type, function f, bool pure, std::vector<bool> read_only_params);
+		void add_public_function_declaration(std::string name, type_factory type, std::shared_ptr<function> fptr);
+		void add_host_global(std::string name, type_factory type, variable_ptr value);
+		
+		class call_scope {
+			call_scope(const call_scope&) = delete;
+			void operator=(const call_scope&) = delete;
+		private:
+			module_impl& _impl;
+			runtime_context& _context;
+		public:
+			explicit call_scope(stork_module& m);
+			
+			runtime_context& context() const {
+				return _context;
+			}
+			
+			~call_scope();
+		};
+		
+		template<typename R, typename... Args, typename F>
+		void add_typed_function(const char* name, F f, function_purity purity) {
+			std::vector<bool> read_only_params{details::is_read_only_argument<Args>::value...};
+			
+			if (purity == function_purity::memoized) {
+				if constexpr(details::is_memoizable<R, Args...>::value) {
+					add_external_function_impl(
+						name,
+						&details::create_function_type<R, Args...>,
+						details::create_external_function<R, Args...>(details::memoize<R, Args...>(std::move(f))),
+						true,
+						std::move(read_only_params)
+					);
+					return;
+				} else {
+					runtime_assertion(false, "Only functions with an owned result and number or string arguments can be memoized");
+				}
+			}
+			
+			add_external_function_impl(
+				name,
+				&details::create_function_type<R, Args...>,
+				details::create_external_function<R, Args...>(std::move(f)),
+				purity != function_purity::impure,
+				std::move(read_only_params)
+			);
+		}
 	public:
 		stork_module();
 		
 		template<typename R, typename... Args>
-		void add_external_function(const char* name, std::function<R(Args...)> f) {
-			add_external_function_impl(
-				details::create_function_declaration<R, Args...>(name),
-				details::create_external_function(std::move(f))
+		void add_external_function(
+			const char* name,
+			std::function<R(Args...)> f,
+			function_purity purity = function_purity::impure
+		) {
+			add_typed_function<R, Args...>(
+				name,
+				[f=std::move(f)](runtime_context&, Args... args) -> R {
+					return f(std::forward<Args>(args)...);
+				},
+				purity
 			);
 		}
 		
+		template<typename R, typename... Args>
+		void add_external_function(
+			const char* name,
+			std::function<R(runtime_context&, Args...)> f,
+			function_purity purity = function_purity::impure
+		) {
+			add_typed_function<R, Args...>(name, std::move(f), purity);
+		}
+		
+		void add_native_function(std::string declaration, function f);
+		
+		template<typename T>
+		global_binding<T> bind_global(std::string name) {
+			auto var = details::create_box<T>();
+			add_host_global(std::move(name), &details::retval_type<T>::get, var);
+			return global_binding<T>(std::move(var));
+		}
+		
 		template<typename R, typename... Args>
 		auto create_public_function_caller(std::string name) {
 			std::shared_ptr<function> fptr = std::make_shared<function>();
-			std::string decl = details::create_function_declaration<R, Args...>(name.c_str());
-			add_public_function_declaration(std::move(decl), std::move(name), fptr);
+			add_public_function_declaration(std::move(name), &details::create_function_type<R, Args...>, fptr);
 			
-			return [this, fptr](Args... args){
+			if constexpr(details::is_direct_callable<R, Args...>::value) {
+				auto caller = std::make_shared<details::direct_caller<R, Args...> >();
+				return [this, fptr, caller](const Args&... args){
+					call_scope scope(*this);
+					return (*caller)(scope.context(), *fptr, args...);
+				};
+			} else return [this, fptr](Args... args){
+				call_scope scope(*this);
 				if constexpr(std::is_same<R, void>::value) {
-					get_runtime_context()->call(
+					scope.context().call(
 						*fptr,
 						{details::to_variable(std::move(args))...}
 					);
 				} else {
-					return details::move_from_variable<R>(get_runtime_context()->call(
+					return details::move_from_variable<R>(scope.context().call(
 						*fptr,
-						{details::to_variable(args)...}
+						{details::to_variable(std::move(args))...}
 					));
 				}
 			};
 		}
 		
+		template<typename R, typename... Args>
+		auto create_public_function_batch_caller(std::string name, size_t threads = 1) {
+			std::shared_ptr<function> fptr = std::make_shared<function>();
+			add_public_function_declaration(std::move(name), &details::create_function_type<R, Args...>, fptr);
+			
+			if constexpr(std::is_same<R, void>::value) {
+				static_assert(sizeof...(Args) > 0, "Batch caller needs at least one argument column");
+				return [this, fptr, threads](std::span<const Args>... columns){
+					size_t rows = std::get<0>(std::make_tuple(columns.size()...));
+					runtime_assertion(((columns.size() == rows) && ...), "Batch column size mismatch");
+					call_scope scope(*this);
+					details::call_batch<R, Args...>(
+						scope.context(), *fptr, rows, threads, nullptr, columns.data()...
+					);
+				};
+			} else {
+				return [this, fptr, threads](std::span<R> results, std::span<const Args>... columns){
+					runtime_assertion(((columns.size() == results.size()) && ...), "Batch column size mismatch");
+					call_scope scope(*this);
+					details::call_batch<R, Args...>(
+						scope.context(), *fptr, results.size(), threads, results.data(), columns.data()...
+					);
+				};
+			}
+		}
+		
 		void load(const char* path);
 		bool try_load(const char* path, std::ostream* err = nullptr) noexcept;
 		
+		void reload(const char* path);
+		bool try_reload(const char* path, std::ostream* err = nullptr) noexcept;
+		
+		void reload_source(std::string_view source);
+		bool try_reload_source(std::string_view source, std::ostream* err = nullptr) noexcept;
+		
+		void load_source(std::string_view source);
+		bool try_load_source(std::string_view source, std::ostream* err = nullptr) noexcept;
+		
+		// Loads tokens produced by prelex(); the module is still parsed and compiled.
+		void load_prelexed(std::string_view data);
+		bool try_load_prelexed(std::string_view data, std::ostream* err = nullptr) noexcept;
+		
+		void load_sources(std::span<const script_source> sources);
+		bool try_load_sources(std::span<const script_source> sources, std::ostream* err = nullptr) noexcept;
+		
 		void reset_globals();
 		
+		void set_operation_budget(size_t operations);
+		void set_deadline(std::chrono::steady_clock::time_point deadline);
+		void clear_budget();
+		
+		void set_task_stack_size(size_t stack_size);
+		
+		void set_random_seed(uint64_t seed);
+		
+		// Caches tokenized sources on disk; parsing and type checking still run on every load.
+		void set_cache_directory(const char* path, size_t max_size = 64 << 20);
+		
+		void set_lazy_compilation(bool lazy);
+		void compile_all();
+		
+		void set_arena_allocation(bool arena);
+		size_t compiled_bytes() const;
+		
 		~stork_module();
 	};
 }
@@ -0,0 +1,201 @@
+#include "prelexed.hpp"
+#include "push_back_stream.hpp"
+#include "tokenizer.hpp"
+#include "errors.hpp"
+#include <bit>
+#include <cstring>
+
+namespace stork {
+	namespace {
+		constexpr char magic[4] = {'S', 'T', 'K', 'B'};
+		constexpr uint32_t reserved_token_count = uint32_t(reserved_token::kw_public) + 1;
+		constexpr size_t header_size = sizeof(magic) + 4 + 8 + 8;
+		
+		enum struct token_kind: uint8_t {
+			reserved,
+			identifier,
+			number,
+			string,
+		};
+		
+		void write_uint(std::string& out, uint64_t value, int bytes) {
+			for (int i = 0; i < bytes; ++i) {
+				out.push_back(char(value >> (8 * i)));
+			}
+		}
+		
+		void write_varint(std::string& out, uint64_t value) {
+			while (value >= 0x80) {
+				out.push_back(char(value | 0x80));
+				value >>= 7;
+			}
+			out.push_back(char(value));
+		}
+		
+		void write_text(std::string& out, std::string_view text) {
+			write_varint(out, text.size());
+			out.append(text);
+		}
+		
+		uint64_t reserved_tokens_hash() {
+			static const uint64_t ret = [] {
+				uint64_t hash = hash_bytes({});
+				for (uint32_t t = 0; t < reserved_token_count; ++t) {
+					hash = hash_bytes(std::to_string(reserved_token(t)), hash);
+					hash = hash_bytes(std::string_view("", 1), hash);
+				}
+				return hash;
+			}();
+			return ret;
+		}
+		
+		class reader {
+		private:
+			std::string_view _data;
+			size_t _pos;
+		public:
+			reader(std::string_view data, size_t pos):
+				_data(data),
+				_pos(pos)
+			{
+			}
+			
+			bool done() const {
+				return _pos == _data.size();
+			}
+			
+			uint64_t read_uint(int bytes) {
+				runtime_assertion(_data.size() - _pos >= size_t(bytes), "Pre-lexed module is truncated");
+				uint64_t ret = 0;
+				for (int i = 0; i < bytes; ++i) {
+					ret |= uint64_t((unsigned char)_data[_pos++]) << (8 * i);
+				}
+				return ret;
+			}
+			
+			uint64_t read_varint() {
+				uint64_t ret = 0;
+				for (int shift = 0; shift < 64; shift += 7) {
+					uint64_t byte = read_uint(1);
+					ret |= (byte & 0x7f) << shift;
+					if (byte < 0x80) {
+						return ret;
+					}
+				}
+				runtime_assertion(false, "Pre-lexed module is corrupt");
+				return ret;
+			}
+			
+			std::string_view read_text() {
+				size_t size = read_varint();
+				runtime_assertion(_data.size() - _pos >= size, "Pre-lexed module is truncated");
+				std::string_view ret = _data.substr(_pos, size);
+				_pos += size;
+				return ret;
+			}
+		};
+	}
+	
+	uint64_t hash_bytes(std::string_view data, uint64_t seed) {
+		uint64_t ret = seed;
+		for (char c : data) {
+			ret ^= (unsigned char)c;
+			ret *= 0x100000001b3;
+		}
+		return ret;
+	}
+	
+	std::string prelex(std::string_view source) {
+		push_back_stream stream(source);
+		tokens_iterator it(stream);
+		
+		std::string payload;
+		for (; !it->is_eof(); ++it) {
+			const token& t = *it;
+			
+			if (t.is_reserved_token()) {
+				write_uint(payload, uint64_t(token_kind::reserved), 1);
+			} else if (t.is_identifier()) {
+				write_uint(payload, uint64_t(token_kind::identifier), 1);
+			} else if (t.is_number()) {
+				write_uint(payload, uint64_t(token_kind::number), 1);
+			} else {
+				write_uint(payload, uint64_t(token_kind::string), 1);
+			}
+			
+			write_varint(payload, t.get_line_number());
+			write_varint(payload, t.get_char_index());
+			
+			if (t.is_reserved_token()) {
+				write_varint(payload, uint64_t(t.get_reserved_token()));
+			} else if (t.is_identifier()) {
+				write_text(payload, t.get_identifier().name());
+			} else if (t.is_number()) {
+				write_uint(payload, std::bit_cast<uint64_t>(t.get_number()), 8);
+			} else {
+				write_text(payload, t.get_string());
+			}
+		}
+		
+		write_uint(payload, it->get_line_number(), 4);
+		write_uint(payload, it->get_char_index(), 4);
+		
+		std::string ret(magic, sizeof(magic));
+		write_uint(ret, prelexed_version, 4);
+		write_uint(ret, reserved_tokens_hash(), 8);
+		write_uint(ret, hash_bytes(payload), 8);
+		ret += payload;
+		return ret;
+	}
+	
+	std::deque<token> read_prelexed(std::string_view data) {
+		runtime_assertion(
+			data.size() >= header_size + 8 && std::memcmp(data.data(), magic, sizeof(magic)) == 0,
+			"Not a pre-lexed module"
+		);
+		
+		reader header(data, sizeof(magic));
+		runtime_assertion(
+			header.read_uint(4) == prelexed_version && header.read_uint(8) == reserved_tokens_hash(),
+			"Pre-lexed module was built by a different version"
+		);
+		runtime_assertion(header.read_uint(8) == hash_bytes(data.substr(header_size)), "Pre-lexed module checksum mismatch");
+		
+		std::deque<token> ret;
+		reader r(data.substr(0, data.size() - 8), header_size);
+		
+		while (!r.done()) {
+			token_kind kind = token_kind(r.read_uint(1));
+			size_t line_number = r.read_varint();
+			size_t char_index = r.read_varint();
+			
+			switch (kind) {
+				case token_kind::reserved:
+				{
+					uint64_t t = r.read_varint();
+					runtime_assertion(t < reserved_token_count, "Pre-lexed module is corrupt");
+					ret.emplace_back(reserved_token(t), line_number, char_index);
+					break;
+				}
+				case token_kind::identifier:
+					ret.emplace_back(identifier{intern(r.read_text())}, line_number, char_index);
+					break;
+				case token_kind::number:
+					ret.emplace_back(std::bit_cast<double>(r.read_uint(8)), line_number, char_index);
+					break;
+				case token_kind::string:
+					ret.emplace_back(string_literal{intern(r.read_text())}, line_number, char_index);
+					break;
+				default:
+					runtime_assertion(false, "Pre-lexed module is corrupt");
+			}
+		}
+		
+		reader tail(data, data.size() - 8);
+		size_t line_number = tail.read_uint(4);
+		size_t char_index = tail.read_uint(4);
+		ret.emplace_back(eof(), line_number, char_index);
+		
+		return ret;
+	}
+}
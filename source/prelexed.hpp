@@ -0,0 +1,22 @@
+#ifndef prelexed_hpp
+#define prelexed_hpp
+
+#include <string>
+#include <string_view>
+#include <deque>
+#include <cstdint>
+#include "tokens.hpp"
+
+namespace stork {
+	constexpr uint32_t prelexed_version = 2;
+	
+	uint64_t hash_bytes(std::string_view data, uint64_t seed = 0xcbf29ce484222325);
+	
+	// Serializes the token stream of the source. Loading the result skips
+	// tokenization only; parsing and type checking still run on every load.
+	std::string prelex(std::string_view source);
+	
+	std::deque<token> read_prelexed(std::string_view data);
+}
+
+#endif /* prelexed_hpp */
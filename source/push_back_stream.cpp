@@ -1,38 +1,22 @@
 #include "push_back_stream.hpp"
 
 namespace stork {
-	push_back_stream::push_back_stream(const get_character* input) :
-		_input(*input),
+	push_back_stream::push_back_stream(std::string_view source) :
+		_source(source),
 		_line_number(0),
 		_char_index(0)
 	{
 	}
-		
-	int push_back_stream::operator()() {
-		int ret = -1;
-		if (_stack.empty()) {
-			ret = _input();
-		} else {
-			ret = _stack.top();
-			_stack.pop();
-		}
-		if (ret == '\n') {
-			++_line_number;
-		}
-		
-		++_char_index;
-		
-		return ret;
+	
+	push_back_stream::push_back_stream(std::string_view source, size_t char_index, size_t line_number) :
+		_source(source),
+		_line_number(line_number),
+		_char_index(char_index)
+	{
 	}
 	
-	void push_back_stream::push_back(int c) {
-		_stack.push(c);
-		
-		if (c == '\n') {
-			--_line_number;
-		}
-		
-		--_char_index;
+	std::string_view push_back_stream::view(size_t from, size_t to) const {
+		return _source.substr(from, to - from);
 	}
 	
 	size_t push_back_stream::line_number() const {
@@ -43,4 +27,3 @@ namespace stork {
 		return _char_index;
 	}
 }
-
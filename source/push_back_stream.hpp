@@ -1,23 +1,38 @@
 #ifndef push_back_stream_h
 #define push_back_stream_h
-#include <stack>
-#include <functional>
+#include <string_view>
 
 namespace stork {
-	using get_character = std::function<int()>;
-
 	class push_back_stream {
 	private:
-		const get_character& _input;
-		std::stack<int> _stack;
+		std::string_view _source;
 		size_t _line_number;
 		size_t _char_index;
 	public:
-		push_back_stream(const get_character* input);
+		push_back_stream(std::string_view source);
+		push_back_stream(std::string_view source, size_t char_index, size_t line_number);
+		
+		int operator()() {
+			size_t idx = _char_index++;
+			if (idx >= _source.size()) {
+				return -1;
+			}
+			
+			int ret = (unsigned char)_source[idx];
+			if (ret == '\n') {
+				++_line_number;
+			}
+			return ret;
+		}
 		
-		int operator()();
+		void push_back(int c) {
+			--_char_index;
+			if (c == '\n' && _char_index < _source.size()) {
+				--_line_number;
+			}
+		}
 		
-		void push_back(int c);
+		std::string_view view(size_t from, size_t to) const;
 		
 		size_t line_number() const;
 		size_t char_index() const;
@@ -0,0 +1,89 @@
+#include "random.hpp"
+#include <cmath>
+
+namespace stork {
+	namespace {
+		uint64_t splitmix64(uint64_t& x) {
+			uint64_t z = (x += 0x9e3779b97f4a7c15);
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+			return z ^ (z >> 31);
+		}
+	}
+	
+	random_generator::random_generator(uint64_t seed) {
+		this->seed(seed);
+	}
+	
+	void random_generator::seed(uint64_t seed) {
+		for (uint64_t& s : _state) {
+			s = splitmix64(seed);
+		}
+		_has_spare = false;
+		_spare = 0;
+	}
+	
+	void random_generator::jump() {
+		static const uint64_t polynomial[] = {
+			0x180ec6d33cfd0aba, 0xd5a61266f0c9392c, 0xa9582618e03fc9aa, 0x39abdc4529b1661c
+		};
+		
+		uint64_t state[4] = {0, 0, 0, 0};
+		for (uint64_t word : polynomial) {
+			for (int b = 0; b < 64; ++b) {
+				if (word & (uint64_t(1) << b)) {
+					for (int i = 0; i < 4; ++i) {
+						state[i] ^= _state[i];
+					}
+				}
+				next();
+			}
+		}
+		
+		for (int i = 0; i < 4; ++i) {
+			_state[i] = state[i];
+		}
+		_has_spare = false;
+	}
+	
+	uint64_t random_generator::below(uint64_t bound) {
+		uint64_t threshold = (0 - bound) % bound;
+		for (;;) {
+			uint64_t r = next();
+			if (r >= threshold) {
+				return r % bound;
+			}
+		}
+	}
+	
+	number random_generator::normal() {
+		if (_has_spare) {
+			_has_spare = false;
+			return _spare;
+		}
+		
+		number u, v, s;
+		do {
+			u = 2 * uniform() - 1;
+			v = 2 * uniform() - 1;
+			s = u * u + v * v;
+		} while (s >= 1 || s == 0);
+		
+		number factor = std::sqrt(-2 * std::log(s) / s);
+		_spare = v * factor;
+		_has_spare = true;
+		return u * factor;
+	}
+	
+	void random_generator::fill_uniform(std::span<number> values) {
+		for (number& value : values) {
+			value = uniform();
+		}
+	}
+	
+	void random_generator::fill_normal(std::span<number> values, number mean, number deviation) {
+		for (number& value : values) {
+			value = mean + deviation * normal();
+		}
+	}
+}
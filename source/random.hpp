@@ -0,0 +1,54 @@
+#ifndef random_hpp
+#define random_hpp
+
+#include <cstdint>
+#include <span>
+#include "variable.hpp"
+
+namespace stork {
+	class random_generator {
+	private:
+		uint64_t _state[4];
+		bool _has_spare;
+		number _spare;
+		
+		static uint64_t rotl(uint64_t x, int k) {
+			return (x << k) | (x >> (64 - k));
+		}
+	public:
+		explicit random_generator(uint64_t seed);
+		
+		void seed(uint64_t seed);
+		
+		void jump();
+		
+		uint64_t next() {
+			uint64_t ret = rotl(_state[1] * 5, 7) * 9;
+			uint64_t t = _state[1] << 17;
+			
+			_state[2] ^= _state[0];
+			_state[3] ^= _state[1];
+			_state[1] ^= _state[2];
+			_state[0] ^= _state[3];
+			
+			_state[2] ^= t;
+			_state[3] = rotl(_state[3], 45);
+			
+			return ret;
+		}
+		
+		number uniform() {
+			return number(next() >> 11) * 0x1.0p-53;
+		}
+		
+		uint64_t below(uint64_t bound);
+		
+		number normal();
+		
+		void fill_uniform(std::span<number> values);
+		
+		void fill_normal(std::span<number> values, number mean, number deviation);
+	};
+}
+
+#endif /* random_hpp */
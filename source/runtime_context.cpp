@@ -1,26 +1,89 @@
 #include "runtime_context.hpp"
 #include "errors.hpp"
+#include "task_scheduler.hpp"
+#include <algorithm>
+#include <limits>
+#include <random>
 
 namespace stork {
+	namespace {
+		constexpr size_t budget_check_interval = 1024;
+		
+		uint64_t random_seed() {
+			std::random_device device;
+			return (uint64_t(device()) << 32) ^ device();
+		}
+	}
+	
 	runtime_context::runtime_context(
 		std::vector<expression<lvalue>::ptr> initializers,
+		std::vector<bool> constant_globals,
+		std::vector<bool> shared_globals,
 		std::vector<function> functions,
 		std::unordered_map<std::string, size_t> public_functions
 	) :
 		_functions(std::move(functions)),
 		_public_functions(std::move(public_functions)),
-		_initializers(std::move(initializers)),
-		_retval_idx(0)
+		_initializers(std::make_shared<std::vector<expression<lvalue>::ptr> >(std::move(initializers))),
+		_snapshot(std::make_shared<std::vector<variable_ptr> >(_initializers->size())),
+		_shared_globals(std::move(shared_globals)),
+		_constant_globals(std::move(constant_globals)),
+		_retval_idx(0),
+		_stack_limit(0),
+		_task_stack_size(0),
+		_random(random_seed())
 	{
-		_globals.reserve(_initializers.size());
+		clear_budget();
 		initialize();
 	}
 	
+	runtime_context::runtime_context(const runtime_context& orig, std::vector<variable_ptr> globals) :
+		_functions(orig._functions),
+		_public_functions(orig._public_functions),
+		_initializers(orig._initializers),
+		_snapshot(orig._snapshot),
+		_shared_globals(orig._shared_globals),
+		_constant_globals(orig._constant_globals),
+		_globals(std::move(globals)),
+		_retval_idx(0),
+		_ticks(orig._ticks),
+		_operations_left(orig._operations_left),
+		_has_deadline(orig._has_deadline),
+		_deadline(orig._deadline),
+		_stack_limit(0),
+		_task_stack_size(orig._task_stack_size),
+		_random(orig._random)
+	{
+	}
+	
+	runtime_context::runtime_context(runtime_context&& orig) noexcept = default;
+	
+	runtime_context::~runtime_context() {
+		if (_tasks) {
+			_tasks->cancel_all(*this);
+		}
+	}
+	
 	void runtime_context::initialize() {
-		_globals.clear();
+		std::vector<variable_ptr> previous;
+		previous.swap(_globals);
+		_globals.reserve(_initializers->size());
 		
-		for (const auto& initializer : _initializers) {
-			_globals.emplace_back(initializer->evaluate(*this));
+		for (size_t i = 0; i < _initializers->size(); ++i) {
+			variable_ptr& initial = (*_snapshot)[i];
+			if (!initial) {
+				_globals.emplace_back((*_initializers)[i]->evaluate(*this));
+				if (i < _constant_globals.size() && _constant_globals[i]) {
+					initial = _shared_globals[i] ? _globals.back() : _globals.back()->clone();
+				}
+			} else if (_shared_globals[i]) {
+				_globals.push_back(initial);
+			} else if (i < previous.size() && previous[i].use_count() == 1) {
+				previous[i]->restore(*initial);
+				_globals.push_back(std::move(previous[i]));
+			} else {
+				_globals.push_back(initial->clone());
+			}
 		}
 	}
 	
@@ -49,30 +112,99 @@ namespace stork {
 		return scope(*this);
 	}
 	
+	runtime_context::frame runtime_context::enter_frame(std::vector<variable_ptr> params) {
+		return frame(*this, std::move(params));
+	}
+	
+	runtime_context::frame runtime_context::enter_frame(std::span<const variable_ptr> params) {
+		return frame(*this, params);
+	}
+	
 	void runtime_context::push(variable_ptr v) {
 		_stack.push_back(std::move(v));
 	}
 
 	variable_ptr runtime_context::call(const function& f, std::vector<variable_ptr> params) {
-		for (size_t i = params.size(); i > 0; --i) {
-			_stack.push_back(std::move(params[i-1]));
+		frame fr(*this, std::move(params));
+		return fr.call(f);
+	}
+	
+	runtime_context runtime_context::fork() {
+		std::vector<variable_ptr> globals;
+		globals.reserve(_globals.size());
+		for (size_t i = 0; i < _globals.size(); ++i) {
+			globals.push_back(_shared_globals[i] ? _globals[i] : _globals[i]->clone());
 		}
-		size_t old_retval_idx = _retval_idx;
-		
-		_retval_idx = _stack.size();
-		_stack.resize(_retval_idx + 1);
-		
-		runtime_assertion(bool(f), "Uninitialized function call");
-		
-		f(*this);
+		runtime_context ret(*this, std::move(globals));
+		_random.jump();
+		return ret;
+	}
+	
+	task_scheduler& runtime_context::tasks() {
+		if (!_tasks) {
+			_tasks = std::make_unique<task_scheduler>();
+			if (_task_stack_size) {
+				_tasks->set_stack_size(_task_stack_size);
+			}
+		}
+		return *_tasks;
+	}
+	
+	void runtime_context::set_task_stack_size(size_t stack_size) {
+		_task_stack_size = stack_size;
+		if (_tasks) {
+			_tasks->set_stack_size(stack_size);
+		}
+	}
+	
+	uintptr_t runtime_context::stack_limit() const {
+		return _stack_limit;
+	}
+	
+	void runtime_context::set_stack_limit(uintptr_t limit) {
+		_stack_limit = limit;
+	}
+	
+	random_generator& runtime_context::random() {
+		return _random;
+	}
+	
+	void runtime_context::swap_stack(std::deque<variable_ptr>& stack, size_t& retval_idx) {
+		std::swap(_stack, stack);
+		std::swap(_retval_idx, retval_idx);
+	}
+	
+	void runtime_context::set_operation_budget(size_t operations) {
+		_ticks = std::min(operations, budget_check_interval);
+		_operations_left = operations - _ticks;
+	}
+	
+	void runtime_context::set_deadline(std::chrono::steady_clock::time_point deadline) {
+		_has_deadline = true;
+		_deadline = deadline;
+	}
+	
+	void runtime_context::clear_budget() {
+		_ticks = budget_check_interval;
+		_operations_left = std::numeric_limits<size_t>::max();
+		_has_deadline = false;
+	}
+	
+	void runtime_context::check_budget() {
+		_ticks = 0;
 		
-		variable_ptr ret = std::move(_stack[_retval_idx]);
+		if (_has_deadline && std::chrono::steady_clock::now() >= _deadline) {
+			throw runtime_error("Execution deadline exceeded");
+		}
 		
-		_stack.resize(_retval_idx - params.size());
+		size_t chunk = std::min(_operations_left, budget_check_interval);
 		
-		_retval_idx = old_retval_idx;
+		if (chunk == 0) {
+			throw runtime_error("Execution budget exceeded");
+		}
 		
-		return ret;
+		_ticks = chunk - 1;
+		_operations_left -= chunk;
 	}
 	
 	runtime_context::scope::scope(runtime_context& context):
@@ -84,4 +216,61 @@ namespace stork {
 	runtime_context::scope::~scope() {
 		_context._stack.resize(_stack_size);
 	}
+	
+	runtime_context::frame::frame(runtime_context& context, std::vector<variable_ptr> params):
+		_context(context),
+		_stack_size(context._stack.size())
+	{
+		for (size_t i = params.size(); i > 0; --i) {
+			_context._stack.push_back(std::move(params[i-1]));
+		}
+	}
+	
+	runtime_context::frame::frame(runtime_context& context, std::span<const variable_ptr> params):
+		_context(context),
+		_stack_size(context._stack.size())
+	{
+		for (size_t i = params.size(); i > 0; --i) {
+			_context._stack.push_back(params[i-1]);
+		}
+	}
+	
+	variable_ptr runtime_context::frame::call(const function& f) {
+		return call(f, nullptr);
+	}
+	
+	variable_ptr runtime_context::frame::call(const function& f, variable_ptr retval) {
+		runtime_assertion(bool(f), "Uninitialized function call");
+		runtime_assertion(
+			_context._stack_limit == 0 || reinterpret_cast<uintptr_t>(&retval) > _context._stack_limit,
+			"Task stack overflow"
+		);
+		
+		size_t old_retval_idx = _context._retval_idx;
+		
+		_context._retval_idx = _context._stack.size();
+		_context._stack.push_back(std::move(retval));
+		
+		try {
+			_context.tick();
+			
+			f(_context);
+		} catch (...) {
+			_context._stack.resize(_context._retval_idx);
+			_context._retval_idx = old_retval_idx;
+			throw;
+		}
+		
+		variable_ptr ret = std::move(_context._stack[_context._retval_idx]);
+		
+		_context._stack.resize(_context._retval_idx);
+		
+		_context._retval_idx = old_retval_idx;
+		
+		return ret;
+	}
+	
+	runtime_context::frame::~frame() {
+		_context._stack.resize(_stack_size);
+	}
 }
@@ -6,19 +6,40 @@
 #include <stack>
 #include <string>
 #include <unordered_map>
+#include <chrono>
+#include <span>
+#include <cstdint>
 #include "variable.hpp"
 #include "lookup.hpp"
 #include "expression.hpp"
+#include "random.hpp"
 
 namespace stork {
+	class task_scheduler;
+	
 	class runtime_context {
 	private:
 		std::vector<function> _functions;
 		std::unordered_map<std::string, size_t> _public_functions;
-		std::vector<expression<lvalue>::ptr> _initializers;
+		std::shared_ptr<std::vector<expression<lvalue>::ptr> > _initializers;
+		std::shared_ptr<std::vector<variable_ptr> > _snapshot;
+		std::vector<bool> _shared_globals;
+		std::vector<bool> _constant_globals;
 		std::vector<variable_ptr> _globals;
 		std::deque<variable_ptr> _stack;
 		size_t _retval_idx;
+		size_t _ticks;
+		size_t _operations_left;
+		bool _has_deadline;
+		std::chrono::steady_clock::time_point _deadline;
+		uintptr_t _stack_limit;
+		size_t _task_stack_size;
+		std::unique_ptr<task_scheduler> _tasks;
+		random_generator _random;
+		
+		void check_budget();
+		
+		runtime_context(const runtime_context& orig, std::vector<variable_ptr> globals);
 		
 		class scope {
 		private:
@@ -29,12 +50,32 @@ namespace stork {
 			~scope();
 		};
 		
+		class frame {
+			frame(const frame&) = delete;
+			void operator=(const frame&) = delete;
+		private:
+			runtime_context& _context;
+			size_t _stack_size;
+		public:
+			frame(runtime_context& context, std::vector<variable_ptr> params);
+			frame(runtime_context& context, std::span<const variable_ptr> params);
+			variable_ptr call(const function& f);
+			variable_ptr call(const function& f, variable_ptr retval);
+			~frame();
+		};
+		
 	public:
 		runtime_context(
 			std::vector<expression<lvalue>::ptr> initializers,
+			std::vector<bool> constant_globals,
+			std::vector<bool> shared_globals,
 			std::vector<function> functions,
 			std::unordered_map<std::string, size_t> public_functions
 		);
+		
+		runtime_context(runtime_context&& orig) noexcept;
+		
+		~runtime_context();
 	
 		void initialize();
 
@@ -46,9 +87,30 @@ namespace stork {
 		const function& get_public_function(const char* name) const;
 
 		scope enter_scope();
+		frame enter_frame(std::vector<variable_ptr> params);
+		frame enter_frame(std::span<const variable_ptr> params);
 		void push(variable_ptr v);
 		
 		variable_ptr call(const function& f, std::vector<variable_ptr> params);
+		
+		runtime_context fork();
+		
+		task_scheduler& tasks();
+		void set_task_stack_size(size_t stack_size);
+		uintptr_t stack_limit() const;
+		void set_stack_limit(uintptr_t limit);
+		random_generator& random();
+		void swap_stack(std::deque<variable_ptr>& stack, size_t& retval_idx);
+		
+		void set_operation_budget(size_t operations);
+		void set_deadline(std::chrono::steady_clock::time_point deadline);
+		void clear_budget();
+		
+		void tick() {
+			if (_ticks-- == 0) {
+				check_budget();
+			}
+		}
 	};
 }
 
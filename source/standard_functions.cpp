@@ -1,86 +1,464 @@
 #include "standard_functions.hpp"
 #include "module.hpp"
+#include "task_scheduler.hpp"
+#include "channel.hpp"
+#include "random.hpp"
+#include "trace_sink.hpp"
 
-#include <iostream>
 #include <string>
 #include <cmath>
-#include <cstdlib>
-#include <ctime>
+#include <charconv>
+#include <span>
+#include <vector>
+#include <functional>
 
 namespace stork {
+	namespace {
+		size_t channel_id(number id) {
+			runtime_assertion(id >= 0 && id < 9007199254740992.0 && id == std::floor(id), "Invalid channel id");
+			return size_t(id);
+		}
+		
+		size_t channel_argument(runtime_context& ctx) {
+			return channel_id(ctx.local(-1)->static_pointer_downcast<lnumber>()->value);
+		}
+		
+		template<typename... Args>
+		void add_spawn_function(stork_module& m, const char* name) {
+			m.add_external_function(name, std::function<number(runtime_context&, script_function<void(Args...)>, Args...)>(
+				[](runtime_context& ctx, script_function<void(Args...)> f, Args... args) {
+					return number(ctx.tasks().spawn(f.get(), {details::to_variable(std::move(args))...}));
+				}
+			));
+		}
+		
+		template<typename T>
+		variable_ptr take_value(runtime_context& ctx, bool by_ref) {
+			variable_ptr v = ctx.local(-2);
+			if (by_ref) {
+				auto var = v->static_pointer_downcast<std::shared_ptr<variable_impl<T> > >();
+				v = std::make_shared<variable_impl<T> >(std::move(var->value));
+				var->value = T{};
+			}
+			return v;
+		}
+		
+		template<typename T>
+		void put_value(runtime_context& ctx, variable_ptr v) {
+			ctx.local(-2)->static_pointer_downcast<std::shared_ptr<variable_impl<T> > >()->value =
+				std::move(v->static_pointer_downcast<std::shared_ptr<variable_impl<T> > >()->value);
+		}
+		
+		template<typename T>
+		void add_channel_functions(
+			stork_module& m,
+			const std::shared_ptr<channel_registry>& channels,
+			const std::string& type,
+			const std::string& suffix,
+			bool by_ref
+		) {
+			std::string param = type + (by_ref ? "& value" : " value");
+			
+			m.add_native_function("function void send" + suffix + "(number ch, " + param + ")", [channels, by_ref](runtime_context& ctx) {
+				channels->get(channel_argument(ctx)).send(take_value<T>(ctx, by_ref));
+			});
+			
+			m.add_native_function("function number try_send" + suffix + "(number ch, " + param + ")", [channels, by_ref](runtime_context& ctx) {
+				variable_ptr v = take_value<T>(ctx, by_ref);
+				bool sent = channels->get(channel_argument(ctx)).try_send(v);
+				if (!sent && by_ref) {
+					put_value<T>(ctx, std::move(v));
+				}
+				ctx.retval() = std::make_shared<variable_impl<number> >(sent);
+			});
+			
+			m.add_native_function("function " + type + " receive" + suffix + "(number ch)", [channels](runtime_context& ctx) {
+				size_t id = channel_argument(ctx);
+				variable_ptr v = channels->get(id).receive();
+				if (!v) {
+					channels->release(id);
+					runtime_assertion(false, "Channel is closed");
+				}
+				ctx.retval() = std::move(v);
+			});
+			
+			m.add_native_function("function number try_receive" + suffix + "(number ch, " + type + "& value)", [channels](runtime_context& ctx) {
+				variable_ptr v;
+				bool received = channels->get(channel_argument(ctx)).try_receive(v);
+				if (received) {
+					put_value<T>(ctx, std::move(v));
+				}
+				ctx.retval() = std::make_shared<variable_impl<number> >(received);
+			});
+		}
+		
+		std::string format(number value, std::chars_format fmt, number precision) {
+			runtime_assertion(precision >= 0 && precision <= 100, "Precision must be between 0 and 100");
+			char buffer[512];
+			std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value, fmt, int(precision));
+			runtime_assertion(result.ec == std::errc(), "Number is too large to format");
+			return std::string(buffer, result.ptr);
+		}
+		
+		constexpr size_t lanes = 8;
+		
+		void check_sizes(size_t size1, size_t size2) {
+			runtime_assertion(size1 == size2, "Array sizes must match");
+		}
+		
+		number sum(std::span<const number> a) {
+			number acc[lanes] = {};
+			size_t n = a.size() - a.size() % lanes;
+			for (size_t i = 0; i < n; i += lanes) {
+				for (size_t j = 0; j < lanes; ++j) {
+					acc[j] += a[i + j];
+				}
+			}
+			number ret = 0;
+			for (size_t j = 0; j < lanes; ++j) {
+				ret += acc[j];
+			}
+			for (size_t i = n; i < a.size(); ++i) {
+				ret += a[i];
+			}
+			return ret;
+		}
+		
+		number dot(std::span<const number> a, std::span<const number> b) {
+			check_sizes(a.size(), b.size());
+			number acc[lanes] = {};
+			size_t n = a.size() - a.size() % lanes;
+			for (size_t i = 0; i < n; i += lanes) {
+				for (size_t j = 0; j < lanes; ++j) {
+					acc[j] += a[i + j] * b[i + j];
+				}
+			}
+			number ret = 0;
+			for (size_t j = 0; j < lanes; ++j) {
+				ret += acc[j];
+			}
+			for (size_t i = n; i < a.size(); ++i) {
+				ret += a[i] * b[i];
+			}
+			return ret;
+		}
+		
+		template<typename Compare>
+		number extreme(std::span<const number> a, Compare compare) {
+			runtime_assertion(!a.empty(), "Array is empty");
+			number acc[lanes];
+			for (size_t j = 0; j < lanes; ++j) {
+				acc[j] = a[0];
+			}
+			size_t n = a.size() - a.size() % lanes;
+			for (size_t i = 0; i < n; i += lanes) {
+				for (size_t j = 0; j < lanes; ++j) {
+					acc[j] = compare(a[i + j], acc[j]) ? a[i + j] : acc[j];
+				}
+			}
+			number ret = acc[0];
+			for (size_t j = 1; j < lanes; ++j) {
+				ret = compare(acc[j], ret) ? acc[j] : ret;
+			}
+			for (size_t i = n; i < a.size(); ++i) {
+				ret = compare(a[i], ret) ? a[i] : ret;
+			}
+			return ret;
+		}
+		
+		template<typename F>
+		std::vector<number> transform(std::span<const number> a, std::span<const number> b, F f) {
+			check_sizes(a.size(), b.size());
+			std::vector<number> ret(a.size());
+			for (size_t i = 0; i < a.size(); ++i) {
+				ret[i] = f(a[i], b[i]);
+			}
+			return ret;
+		}
+		
+		template<typename F>
+		void add_elementwise_function(stork_module& m, const char* name, F f) {
+			m.add_external_function(name, std::function<void(std::span<number>)>(
+				[f](std::span<number> a) {
+					for (number& x : a) {
+						x = f(x);
+					}
+				}
+			));
+		}
+	}
 
 	void add_math_functions(stork_module& m) {
 		m.add_external_function("sin", std::function<number(number)>(
 			[](number x) {
 				return std::sin(x);
 			}
-		));
+		), function_purity::pure);
 		
 		m.add_external_function("cos", std::function<number(number)>(
 			[](number x) {
 				return std::cos(x);
 			}
-		));
+		), function_purity::pure);
 		
 		m.add_external_function("tan", std::function<number(number)>(
 			[](number x) {
 				return std::tan(x);
 			}
-		));
+		), function_purity::pure);
 		
 		m.add_external_function("log", std::function<number(number)>(
 			[](number x) {
 				return std::log(x);
 			}
-		));
+		), function_purity::pure);
 		
 		m.add_external_function("exp", std::function<number(number)>(
 			[](number x) {
 				return std::exp(x);
 			}
-		));
+		), function_purity::pure);
 		
 		m.add_external_function("pow", std::function<number(number, number)>(
 			[](number x, number y) {
 				return std::pow(x, y);
 			}
+		), function_purity::pure);
+		
+	}
+	
+	void add_random_functions(stork_module& m) {
+		m.add_external_function("rnd", std::function<number(runtime_context&, number)>(
+			[](runtime_context& ctx, number x) {
+				runtime_assertion(x >= 1, "rnd bound must be at least 1");
+				return number(ctx.random().below(uint64_t(x)));
+			}
 		));
 		
-		srand((unsigned int)time(0));
+		m.add_external_function("random_seed", std::function<void(runtime_context&, number)>(
+			[](runtime_context& ctx, number seed) {
+				ctx.random().seed(uint64_t(int64_t(seed)));
+			}
+		));
 		
-		m.add_external_function("rnd", std::function<number(number)>(
-			[](number x) {
-				return rand() % int(x);
+		m.add_external_function("random_uniform", std::function<number(runtime_context&)>(
+			[](runtime_context& ctx) {
+				return ctx.random().uniform();
+			}
+		));
+		
+		m.add_external_function("random_range", std::function<number(runtime_context&, number, number)>(
+			[](runtime_context& ctx, number from, number to) {
+				int64_t lo = int64_t(std::ceil(from));
+				int64_t hi = int64_t(std::floor(to));
+				runtime_assertion(lo <= hi, "random_range contains no integers");
+				return number(lo + int64_t(ctx.random().below(uint64_t(hi - lo) + 1)));
+			}
+		));
+		
+		m.add_external_function("random_normal", std::function<number(runtime_context&, number, number)>(
+			[](runtime_context& ctx, number mean, number deviation) {
+				return mean + deviation * ctx.random().normal();
+			}
+		));
+		
+		m.add_external_function("random_fill", std::function<void(runtime_context&, std::span<number>)>(
+			[](runtime_context& ctx, std::span<number> values) {
+				ctx.random().fill_uniform(values);
+			}
+		));
+		
+		m.add_external_function("random_fill_normal", std::function<void(runtime_context&, std::span<number>, number, number)>(
+			[](runtime_context& ctx, std::span<number> values, number mean, number deviation) {
+				ctx.random().fill_normal(values, mean, deviation);
 			}
 		));
 	}
 	
+	void add_array_functions(stork_module& m) {
+		m.add_external_function("array_sum", std::function<number(std::span<const number>)>(sum));
+		
+		m.add_external_function("array_dot", std::function<number(std::span<const number>, std::span<const number>)>(dot));
+		
+		m.add_external_function("array_min", std::function<number(std::span<const number>)>(
+			[](std::span<const number> a) {
+				return extreme(a, std::less<number>());
+			}
+		));
+		
+		m.add_external_function("array_max", std::function<number(std::span<const number>)>(
+			[](std::span<const number> a) {
+				return extreme(a, std::greater<number>());
+			}
+		));
+		
+		m.add_external_function("array_add", std::function<std::vector<number>(std::span<const number>, std::span<const number>)>(
+			[](std::span<const number> a, std::span<const number> b) {
+				return transform(a, b, std::plus<number>());
+			}
+		));
+		
+		m.add_external_function("array_mul", std::function<std::vector<number>(std::span<const number>, std::span<const number>)>(
+			[](std::span<const number> a, std::span<const number> b) {
+				return transform(a, b, std::multiplies<number>());
+			}
+		));
+		
+		m.add_external_function("array_fma", std::function<std::vector<number>(std::span<const number>, std::span<const number>, std::span<const number>)>(
+			[](std::span<const number> a, std::span<const number> b, std::span<const number> c) {
+				check_sizes(a.size(), b.size());
+				check_sizes(a.size(), c.size());
+				std::vector<number> ret(a.size());
+				for (size_t i = 0; i < a.size(); ++i) {
+					ret[i] = a[i] * b[i] + c[i];
+				}
+				return ret;
+			}
+		));
+		
+		m.add_external_function("array_prefix_sum", std::function<std::vector<number>(std::span<const number>)>(
+			[](std::span<const number> a) {
+				std::vector<number> ret(a.size());
+				number acc = 0;
+				for (size_t i = 0; i < a.size(); ++i) {
+					acc += a[i];
+					ret[i] = acc;
+				}
+				return ret;
+			}
+		));
+		
+		m.add_external_function("array_axpy", std::function<void(std::span<number>, number, std::span<const number>)>(
+			[](std::span<number> y, number a, std::span<const number> x) {
+				check_sizes(y.size(), x.size());
+				for (size_t i = 0; i < y.size(); ++i) {
+					y[i] += a * x[i];
+				}
+			}
+		));
+		
+		m.add_external_function("array_scale", std::function<void(std::span<number>, number)>(
+			[](std::span<number> a, number k) {
+				for (number& x : a) {
+					x *= k;
+				}
+			}
+		));
+		
+		add_elementwise_function(m, "array_abs", [](number x) { return std::fabs(x); });
+		add_elementwise_function(m, "array_sqrt", [](number x) { return std::sqrt(x); });
+		add_elementwise_function(m, "array_sin", [](number x) { return std::sin(x); });
+		add_elementwise_function(m, "array_cos", [](number x) { return std::cos(x); });
+		add_elementwise_function(m, "array_exp", [](number x) { return std::exp(x); });
+		add_elementwise_function(m, "array_log", [](number x) { return std::log(x); });
+	}
+	
 	void add_string_functions(stork_module& m) {
 		m.add_external_function("strlen", std::function<number(const std::string&)>(
 			[](const std::string& str) {
 				return number(str.size());
 			}
-		));
+		), function_purity::pure);
 		
 		m.add_external_function("substr", std::function<std::string(const std::string&, number, number)>(
 			[](const std::string& str, number from, number count) {
 				return str.substr(size_t(from), size_t(count));
 			}
-		));
+		), function_purity::pure);
+	}
+	
+	void add_conversion_functions(stork_module& m) {
+		m.add_external_function("tonumber", std::function<number(std::string_view)>(
+			[](std::string_view str) {
+				number ret = 0;
+				std::from_chars_result result = std::from_chars(str.data(), str.data() + str.size(), ret);
+				runtime_assertion(result.ec == std::errc() && result.ptr == str.data() + str.size(), "Invalid number");
+				return ret;
+			}
+		), function_purity::pure);
+		
+		m.add_external_function("format_number", std::function<std::string(number, number)>(
+			[](number value, number precision) {
+				return format(value, std::chars_format::fixed, precision);
+			}
+		), function_purity::pure);
+		
+		m.add_external_function("format_scientific", std::function<std::string(number, number)>(
+			[](number value, number precision) {
+				return format(value, std::chars_format::scientific, precision);
+			}
+		), function_purity::pure);
 	}
 	
 	void add_trace_functions(stork_module& m) {
-		m.add_external_function("trace", std::function<void(const std::string&)>(
-			[](const std::string& str) {
-				std::cout << str << std::endl;
+		add_trace_functions(m, std::make_shared<trace_sink>(standard_output()));
+	}
+	
+	void add_trace_functions(stork_module& m, std::shared_ptr<trace_sink> sink) {
+		m.add_external_function("trace", std::function<void(std::string_view)>(
+			[sink](std::string_view str) {
+				sink->trace(str);
+			}
+		));
+	}
+	
+	void add_task_functions(stork_module& m) {
+		add_spawn_function<number>(m, "spawn");
+		add_spawn_function<>(m, "spawn_void");
+		add_spawn_function<std::string>(m, "spawn_string");
+		
+		m.add_external_function("yield", std::function<void(runtime_context&)>(
+			[](runtime_context& ctx) {
+				ctx.tasks().yield(ctx);
+			}
+		));
+		
+		m.add_external_function("join", std::function<void(runtime_context&, number)>(
+			[](runtime_context& ctx, number id) {
+				ctx.tasks().join(ctx, size_t(id));
 			}
 		));
+		
+		m.add_external_function("detach", std::function<void(runtime_context&, number)>(
+			[](runtime_context& ctx, number id) {
+				ctx.tasks().detach(size_t(id));
+			}
+		));
+	}
+	
+	void add_channel_functions(stork_module& m) {
+		add_channel_functions(m, std::make_shared<channel_registry>());
+	}
+	
+	void add_channel_functions(stork_module& m, std::shared_ptr<channel_registry> channels) {
+		m.add_external_function("channel", std::function<number(number)>(
+			[channels](number capacity) {
+				runtime_assertion(capacity >= 1 && capacity <= 16777216 && capacity == std::floor(capacity), "Invalid channel capacity");
+				return number(channels->create(size_t(capacity)));
+			}
+		));
+		
+		m.add_external_function("close_channel", std::function<void(number)>(
+			[channels](number id) {
+				channels->close(channel_id(id));
+			}
+		));
+		
+		add_channel_functions<number>(m, channels, "number", "", false);
+		add_channel_functions<string>(m, channels, "string", "_string", false);
+		add_channel_functions<array>(m, channels, "number[]", "_array", true);
+		add_channel_functions<array>(m, channels, "string[]", "_string_array", true);
 	}
 	
 	void add_standard_functions(stork_module& m) {
 		add_math_functions(m);
+		add_random_functions(m);
+		add_array_functions(m);
 		add_string_functions(m);
+		add_conversion_functions(m);
 		add_trace_functions(m);
+		add_task_functions(m);
+		add_channel_functions(m);
 	}
 
 }
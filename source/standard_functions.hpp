@@ -1,13 +1,24 @@
 #ifndef standard_functions_hpp
 #define standard_functions_hpp
 
+#include <memory>
+
 namespace stork {
 
 	class stork_module;
+	class trace_sink;
+	class channel_registry;
 	
 	void add_math_functions(stork_module& m);
+	void add_random_functions(stork_module& m);
+	void add_array_functions(stork_module& m);
 	void add_string_functions(stork_module& m);
+	void add_conversion_functions(stork_module& m);
 	void add_trace_functions(stork_module& m);
+	void add_trace_functions(stork_module& m, std::shared_ptr<trace_sink> sink);
+	void add_task_functions(stork_module& m);
+	void add_channel_functions(stork_module& m);
+	void add_channel_functions(stork_module& m, std::shared_ptr<channel_registry> channels);
 	
 	void add_standard_functions(stork_module& m);
 }
@@ -129,6 +129,27 @@ namespace stork {
 			}
 		};
 		
+		template<typename T>
+		class typed_return_statement: public statement {
+		private:
+			typename expression<T>::ptr _expr;
+		public:
+			typed_return_statement(typename expression<T>::ptr expr) :
+				_expr(std::move(expr))
+			{
+			}
+			
+			flow execute(runtime_context& context) override {
+				variable_ptr& retval = context.retval();
+				if (retval) {
+					static_cast<variable_impl<T>&>(*retval).value = _expr->evaluate(context);
+				} else {
+					retval = std::make_shared<variable_impl<T> >(_expr->evaluate(context));
+				}
+				return flow::return_flow();
+			}
+		};
+		
 		class return_void_statement: public statement {
 		public:
 			return_void_statement() = default;
@@ -261,6 +282,7 @@ namespace stork {
 			
 			flow execute(runtime_context& context) override {
 				while (_expr->evaluate(context)) {
+					context.tick();
 					switch (flow f = _statement->execute(context); f.type()) {
 						case flow_type::f_normal:
 						case flow_type::f_continue:
@@ -289,6 +311,7 @@ namespace stork {
 			
 			flow execute(runtime_context& context) override {
 				do {
+					context.tick();
 					switch (flow f = _statement->execute(context); f.type()) {
 						case flow_type::f_normal:
 						case flow_type::f_continue:
@@ -323,6 +346,7 @@ namespace stork {
 			
 			flow execute(runtime_context& context) override {
 				for (; _expr2->evaluate(context); _expr3->evaluate(context)) {
+					context.tick();
 					switch (flow f = _statement->execute(context); f.type()) {
 						case flow_type::f_normal:
 						case flow_type::f_continue:
@@ -418,6 +442,14 @@ namespace stork {
 		return std::make_unique<return_statement>(std::move(expr));
 	}
 	
+	statement_ptr create_return_number_statement(expression<number>::ptr expr) {
+		return std::make_unique<typed_return_statement<number> >(std::move(expr));
+	}
+	
+	statement_ptr create_return_string_statement(expression<string>::ptr expr) {
+		return std::make_unique<typed_return_statement<string> >(std::move(expr));
+	}
+	
 	statement_ptr create_return_void_statement() {
 		return std::make_unique<return_void_statement>();
 	}
@@ -31,7 +31,7 @@ namespace stork {
 	
 	class runtime_context;
 	
-	class statement {
+	class statement: public arena_allocated {
 		statement(const statement&) = delete;
 		void operator=(const statement&) = delete;
 	protected:
@@ -57,6 +57,10 @@ namespace stork {
 	
 	statement_ptr create_return_statement(expression<lvalue>::ptr expr);
 	
+	statement_ptr create_return_number_statement(expression<number>::ptr expr);
+	
+	statement_ptr create_return_string_statement(expression<string>::ptr expr);
+	
 	statement_ptr create_return_void_statement();
 	
 	statement_ptr create_if_statement(
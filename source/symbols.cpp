@@ -0,0 +1,54 @@
+#include "symbols.hpp"
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <shared_mutex>
+#include <mutex>
+
+namespace stork {
+	namespace {
+		class symbol_table {
+		private:
+			mutable std::shared_mutex _mutex;
+			std::deque<std::string> _names;
+			std::unordered_map<std::string_view, symbol> _symbols;
+		public:
+			symbol intern(std::string_view name) {
+				{
+					std::shared_lock<std::shared_mutex> lock(_mutex);
+					if (auto it = _symbols.find(name); it != _symbols.end()) {
+						return it->second;
+					}
+				}
+				
+				std::unique_lock<std::shared_mutex> lock(_mutex);
+				if (auto it = _symbols.find(name); it != _symbols.end()) {
+					return it->second;
+				}
+				
+				symbol ret = symbol(_names.size());
+				_names.emplace_back(name);
+				_symbols.emplace(_names.back(), ret);
+				return ret;
+			}
+			
+			std::string_view name(symbol s) const {
+				std::shared_lock<std::shared_mutex> lock(_mutex);
+				return _names[s];
+			}
+		};
+		
+		symbol_table& symbols() {
+			static symbol_table table;
+			return table;
+		}
+	}
+	
+	symbol intern(std::string_view name) {
+		return symbols().intern(name);
+	}
+	
+	std::string_view symbol_name(symbol s) {
+		return symbols().name(s);
+	}
+}
@@ -0,0 +1,15 @@
+#ifndef symbols_hpp
+#define symbols_hpp
+
+#include <cstdint>
+#include <string_view>
+
+namespace stork {
+	using symbol = uint32_t;
+	
+	symbol intern(std::string_view name);
+	
+	std::string_view symbol_name(symbol s);
+}
+
+#endif /* symbols_hpp */
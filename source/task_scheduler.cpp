@@ -0,0 +1,317 @@
+#if defined(__APPLE__) && !defined(_XOPEN_SOURCE)
+#define _XOPEN_SOURCE 600
+#endif
+
+#include "task_scheduler.hpp"
+#include <cstdint>
+#include <algorithm>
+#include <deque>
+#include <exception>
+#include "runtime_context.hpp"
+#include "errors.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <ucontext.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace stork {
+	namespace {
+		constexpr size_t default_stack_size = 256 * 1024;
+		constexpr size_t min_stack_size = 64 * 1024;
+		constexpr size_t stack_reserve = 32 * 1024;
+
+		struct task_cancelled {
+		};
+	}
+
+#ifndef _WIN32
+	class task_scheduler::task_stack {
+		task_stack(const task_stack&) = delete;
+		void operator=(const task_stack&) = delete;
+	private:
+		char* _mapping;
+		size_t _mapping_size;
+		size_t _guard_size;
+	public:
+		explicit task_stack(size_t size):
+			_guard_size(size_t(sysconf(_SC_PAGESIZE)))
+		{
+			_mapping_size = (size + _guard_size - 1) / _guard_size * _guard_size + _guard_size;
+			void* mapping = mmap(nullptr, _mapping_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			runtime_assertion(mapping != MAP_FAILED, "Failed to allocate task stack");
+			_mapping = static_cast<char*>(mapping);
+			mprotect(_mapping, _guard_size, PROT_NONE);
+		}
+
+		char* base() const {
+			return _mapping + _guard_size;
+		}
+
+		size_t size() const {
+			return _mapping_size - _guard_size;
+		}
+
+		uintptr_t limit() const {
+			return reinterpret_cast<uintptr_t>(base()) + stack_reserve;
+		}
+
+		~task_stack() {
+			munmap(_mapping, _mapping_size);
+		}
+	};
+#else
+	class task_scheduler::task_stack {
+	};
+#endif
+
+	struct task_scheduler::task {
+		size_t id = 0;
+		task_scheduler* scheduler = nullptr;
+		runtime_context* ctx = nullptr;
+		function f;
+		std::vector<variable_ptr> params;
+		std::deque<variable_ptr> stack;
+		size_t retval_idx = 0;
+		bool started = false;
+		bool finished = false;
+		bool cancelled = false;
+		bool detached = false;
+		std::exception_ptr error;
+		task* next = nullptr;
+		uintptr_t stack_limit = 0;
+#ifdef _WIN32
+		LPVOID fiber = nullptr;
+#else
+		ucontext_t context;
+		std::unique_ptr<task_stack> stack_memory;
+#endif
+	};
+
+	task_scheduler::task_scheduler():
+		_main(std::make_unique<task>()),
+		_head(nullptr),
+		_tail(nullptr),
+		_current(nullptr),
+		_ready(0),
+		_next_id(1),
+		_stack_size(default_stack_size)
+	{
+	}
+
+	void task_scheduler::enqueue(task* t) {
+		t->next = nullptr;
+		if (_tail) {
+			_tail->next = t;
+		} else {
+			_head = t;
+		}
+		_tail = t;
+		++_ready;
+	}
+
+	task_scheduler::task* task_scheduler::dequeue() {
+		task* t = _head;
+		if (t) {
+			_head = t->next;
+			if (!_head) {
+				_tail = nullptr;
+			}
+			--_ready;
+		}
+		return t;
+	}
+
+	void task_scheduler::resume(runtime_context& ctx, task* t) {
+		if (!t->started) {
+			t->started = true;
+			t->scheduler = this;
+			t->ctx = &ctx;
+#ifdef _WIN32
+			t->fiber = CreateFiber(_stack_size, [](LPVOID p) {
+				run_task(static_cast<task*>(p));
+			}, t);
+			runtime_assertion(t->fiber != nullptr, "Failed to create task");
+#else
+			if (_free_stacks.empty()) {
+				t->stack_memory = std::make_unique<task_stack>(_stack_size);
+			} else {
+				t->stack_memory = std::move(_free_stacks.back());
+				_free_stacks.pop_back();
+			}
+			t->stack_limit = t->stack_memory->limit();
+
+			getcontext(&t->context);
+			t->context.uc_stack.ss_sp = t->stack_memory->base();
+			t->context.uc_stack.ss_size = t->stack_memory->size();
+			t->context.uc_link = nullptr;
+
+			uint64_t p = uint64_t(reinterpret_cast<uintptr_t>(t));
+			void(*entry)(unsigned, unsigned) = [](unsigned hi, unsigned lo) {
+				run_task(reinterpret_cast<task*>(uintptr_t((uint64_t(hi) << 32) | lo)));
+			};
+			makecontext(&t->context, reinterpret_cast<void(*)()>(entry), 2, unsigned(p >> 32), unsigned(p));
+#endif
+		}
+
+		_current = t;
+		ctx.swap_stack(t->stack, t->retval_idx);
+		uintptr_t host_stack_limit = ctx.stack_limit();
+		ctx.set_stack_limit(t->stack_limit);
+
+#ifdef _WIN32
+		_main->fiber = IsThreadAFiber() ? GetCurrentFiber() : ConvertThreadToFiber(nullptr);
+		SwitchToFiber(t->fiber);
+#else
+		swapcontext(&_main->context, &t->context);
+#endif
+
+		ctx.set_stack_limit(host_stack_limit);
+		ctx.swap_stack(t->stack, t->retval_idx);
+		_current = nullptr;
+
+		if (t->finished) {
+			retire(t);
+		}
+	}
+
+	void task_scheduler::retire(task* t) {
+#ifdef _WIN32
+		DeleteFiber(t->fiber);
+		t->fiber = nullptr;
+#else
+		_free_stacks.push_back(std::move(t->stack_memory));
+#endif
+		if (!t->detached) {
+			_results.emplace(t->id, std::move(t->error));
+		}
+		_tasks.erase(t->id);
+	}
+
+	void task_scheduler::suspend() {
+#ifdef _WIN32
+		SwitchToFiber(_main->fiber);
+#else
+		swapcontext(&_current->context, &_main->context);
+#endif
+	}
+
+	void task_scheduler::run_task(task* t) {
+#ifdef _WIN32
+		ULONG_PTR low, high;
+		GetCurrentThreadStackLimits(&low, &high);
+		t->stack_limit = uintptr_t(low) + stack_reserve;
+		t->ctx->set_stack_limit(t->stack_limit);
+#endif
+		try {
+			t->ctx->call(t->f, std::move(t->params));
+		} catch (const task_cancelled&) {
+		} catch (...) {
+			t->error = std::current_exception();
+		}
+
+		t->finished = true;
+		t->f = nullptr;
+		t->scheduler->suspend();
+	}
+
+	size_t task_scheduler::spawn(function f, std::vector<variable_ptr> params) {
+		size_t id = _next_id++;
+
+		std::unique_ptr<task> t = std::make_unique<task>();
+		t->id = id;
+		t->f = std::move(f);
+		t->params = std::move(params);
+
+		enqueue(t.get());
+		_tasks.emplace(id, std::move(t));
+
+		return id;
+	}
+
+	void task_scheduler::yield(runtime_context& ctx) {
+		if (task* t = _current) {
+			enqueue(t);
+			suspend();
+			if (t->cancelled) {
+				throw task_cancelled();
+			}
+		} else {
+			for (size_t n = _ready; n > 0 && _head; --n) {
+				resume(ctx, dequeue());
+			}
+		}
+	}
+
+	void task_scheduler::join(runtime_context& ctx, size_t id) {
+		auto it = _tasks.find(id);
+
+		runtime_assertion(it != _tasks.end() || _results.count(id) > 0, "Invalid task id");
+		runtime_assertion(it == _tasks.end() || it->second.get() != _current, "Task cannot join itself");
+
+		while (_tasks.count(id) > 0) {
+			if (_current) {
+				yield(ctx);
+			} else {
+				task* t = dequeue();
+				runtime_assertion(t != nullptr, "Task is not runnable");
+				resume(ctx, t);
+			}
+		}
+
+		if (auto result = _results.find(id); result != _results.end()) {
+			std::exception_ptr error = std::move(result->second);
+			_results.erase(result);
+			if (error) {
+				std::rethrow_exception(error);
+			}
+		}
+	}
+
+	void task_scheduler::detach(size_t id) {
+		if (auto it = _tasks.find(id); it != _tasks.end()) {
+			it->second->detached = true;
+		} else {
+			runtime_assertion(_results.erase(id) > 0, "Invalid task id");
+		}
+	}
+
+	void task_scheduler::run(runtime_context& ctx) {
+		runtime_assertion(_current == nullptr, "Tasks can only be run from the host");
+
+		while (task* t = dequeue()) {
+			resume(ctx, t);
+		}
+	}
+
+	void task_scheduler::cancel_all(runtime_context& ctx) {
+		std::vector<task*> running;
+		for (auto& p : _tasks) {
+			if (p.second->started) {
+				running.push_back(p.second.get());
+			}
+		}
+
+		for (task* t : running) {
+			t->cancelled = true;
+			resume(ctx, t);
+		}
+
+		_head = nullptr;
+		_tail = nullptr;
+		_ready = 0;
+		_tasks.clear();
+		_results.clear();
+	}
+
+	void task_scheduler::set_stack_size(size_t stack_size) {
+		_stack_size = std::max(stack_size, min_stack_size);
+		_free_stacks.clear();
+	}
+
+	task_scheduler::~task_scheduler() {
+	}
+}
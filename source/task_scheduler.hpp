@@ -0,0 +1,54 @@
+#ifndef task_scheduler_hpp
+#define task_scheduler_hpp
+
+#include <memory>
+#include <vector>
+#include <unordered_map>
+#include <exception>
+#include "variable.hpp"
+
+namespace stork {
+	class runtime_context;
+
+	class task_scheduler {
+		task_scheduler(const task_scheduler&) = delete;
+		void operator=(const task_scheduler&) = delete;
+	private:
+		struct task;
+		class task_stack;
+
+		std::unordered_map<size_t, std::unique_ptr<task> > _tasks;
+		std::unordered_map<size_t, std::exception_ptr> _results;
+		std::unique_ptr<task> _main;
+		std::vector<std::unique_ptr<task_stack> > _free_stacks;
+		task* _head;
+		task* _tail;
+		task* _current;
+		size_t _ready;
+		size_t _next_id;
+		size_t _stack_size;
+
+		void enqueue(task* t);
+		task* dequeue();
+		void resume(runtime_context& ctx, task* t);
+		void suspend();
+		void retire(task* t);
+
+		static void run_task(task* t);
+	public:
+		task_scheduler();
+
+		size_t spawn(function f, std::vector<variable_ptr> params);
+		void yield(runtime_context& ctx);
+		void join(runtime_context& ctx, size_t id);
+		void detach(size_t id);
+		void run(runtime_context& ctx);
+		void cancel_all(runtime_context& ctx);
+
+		void set_stack_size(size_t stack_size);
+
+		~task_scheduler();
+	};
+}
+
+#endif /* task_scheduler_hpp */
@@ -0,0 +1,174 @@
+#include "token_cache.hpp"
+#include "prelexed.hpp"
+#include "errors.hpp"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <optional>
+
+namespace stork {
+	namespace {
+		const char* extension = ".stkb";
+		
+		std::string cache_key(std::string_view source, std::string_view environment) {
+			uint64_t hash = hash_bytes(std::to_string(engine_version) + "." + std::to_string(prelexed_version));
+			hash = hash_bytes(environment, hash);
+			hash = hash_bytes(source, hash);
+			std::ostringstream ret;
+			ret << std::hex << std::setw(16) << std::setfill('0') << hash;
+			return ret.str();
+		}
+		
+		void write_size(std::string& out, size_t size) {
+			for (int i = 0; i < 8; ++i) {
+				out.push_back(char(uint64_t(size) >> (8 * i)));
+			}
+		}
+		
+		bool read_text(std::string_view& data, std::string_view& text) {
+			if (data.size() < 8) {
+				return false;
+			}
+			uint64_t size = 0;
+			for (int i = 0; i < 8; ++i) {
+				size |= uint64_t((unsigned char)data[i]) << (8 * i);
+			}
+			data.remove_prefix(8);
+			if (data.size() < size) {
+				return false;
+			}
+			text = data.substr(0, size);
+			data.remove_prefix(size);
+			return true;
+		}
+		
+		std::string create_entry(std::string_view source, std::string_view environment) {
+			std::string ret;
+			write_size(ret, environment.size());
+			ret.append(environment);
+			write_size(ret, source.size());
+			ret.append(source);
+			ret += prelex(source);
+			return ret;
+		}
+		
+		std::optional<std::string_view> entry_tokens(std::string_view data, std::string_view source, std::string_view environment) {
+			std::string_view stored_environment;
+			std::string_view stored_source;
+			if (
+				!read_text(data, stored_environment) || stored_environment != environment ||
+				!read_text(data, stored_source) || stored_source != source
+			) {
+				return std::nullopt;
+			}
+			return data;
+		}
+		
+		bool read_file(const std::filesystem::path& path, std::string& data) {
+			std::ifstream in(path, std::ios::binary);
+			if (!in) {
+				return false;
+			}
+			std::ostringstream ret;
+			ret << in.rdbuf();
+			data = ret.str();
+			return bool(in);
+		}
+	}
+	
+	token_cache::token_cache(std::filesystem::path directory, size_t max_size):
+		_directory(std::move(directory)),
+		_max_size(max_size)
+	{
+		std::error_code ec;
+		std::filesystem::create_directories(_directory, ec);
+	}
+	
+	std::deque<token> token_cache::get(std::string_view source, std::string_view environment) const {
+		std::filesystem::path path = _directory / (cache_key(source, environment) + extension);
+		
+		std::string data;
+		if (read_file(path, data)) {
+			try {
+				std::optional<std::string_view> tokens = entry_tokens(data, source, environment);
+				runtime_assertion(bool(tokens), "Cache entry does not match the source");
+				std::deque<token> ret = read_prelexed(*tokens);
+				std::error_code ec;
+				std::filesystem::last_write_time(path, std::filesystem::file_time_type::clock::now(), ec);
+				return ret;
+			} catch (const runtime_error&) {
+			}
+		}
+		
+		data = create_entry(source, environment);
+		store(path, data);
+		evict();
+		return read_prelexed(*entry_tokens(data, source, environment));
+	}
+	
+	void token_cache::store(const std::filesystem::path& path, const std::string& data) const {
+		std::filesystem::path temp = path;
+		temp += "." + std::to_string(std::random_device()()) + ".tmp";
+		
+		{
+			std::ofstream out(temp, std::ios::binary);
+			if (!out.write(data.data(), data.size())) {
+				out.close();
+				std::error_code ec;
+				std::filesystem::remove(temp, ec);
+				return;
+			}
+		}
+		
+		std::error_code ec;
+		std::filesystem::rename(temp, path, ec);
+		if (ec) {
+			std::filesystem::remove(temp, ec);
+		}
+	}
+	
+	void token_cache::evict() const {
+		struct entry {
+			std::filesystem::path path;
+			std::filesystem::file_time_type time;
+			size_t size;
+		};
+		
+		std::vector<entry> entries;
+		size_t total = 0;
+		
+		std::error_code ec;
+		for (const auto& it : std::filesystem::directory_iterator(_directory, ec)) {
+			if (it.path().extension() != extension) {
+				continue;
+			}
+			std::error_code entry_ec;
+			size_t size = it.file_size(entry_ec);
+			std::filesystem::file_time_type time = it.last_write_time(entry_ec);
+			if (!entry_ec) {
+				entries.push_back(entry{it.path(), time, size});
+				total += size;
+			}
+		}
+		
+		if (total <= _max_size) {
+			return;
+		}
+		
+		std::sort(entries.begin(), entries.end(), [](const entry& l, const entry& r) {
+			return l.time < r.time;
+		});
+		
+		for (const entry& e : entries) {
+			if (total <= _max_size) {
+				break;
+			}
+			if (std::filesystem::remove(e.path, ec)) {
+				total -= e.size;
+			}
+		}
+	}
+}
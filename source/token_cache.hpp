@@ -0,0 +1,30 @@
+#ifndef token_cache_hpp
+#define token_cache_hpp
+
+#include <string>
+#include <string_view>
+#include <filesystem>
+#include <deque>
+#include <cstdint>
+#include "tokens.hpp"
+
+namespace stork {
+	constexpr uint32_t engine_version = 1;
+	
+	// Caches the token stream of a source on disk. Parsing and type checking
+	// are not cached and still run on every load.
+	class token_cache {
+	private:
+		std::filesystem::path _directory;
+		size_t _max_size;
+		
+		void store(const std::filesystem::path& path, const std::string& data) const;
+		void evict() const;
+	public:
+		token_cache(std::filesystem::path directory, size_t max_size);
+		
+		std::deque<token> get(std::string_view source, std::string_view environment) const;
+	};
+}
+
+#endif /* token_cache_hpp */
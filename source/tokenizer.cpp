@@ -3,7 +3,7 @@
 #include <string>
 #include <cctype>
 #include <stack>
-#include <cstdlib>
+#include <charconv>
 #include "push_back_stream.hpp"
 #include "errors.hpp"
 
@@ -29,49 +29,70 @@ namespace stork {
 			return character_type::punct;
 		}
 		
+		double parse_number(std::string_view word, const char*& endptr) {
+			const char* first = word.data();
+			const char* last = first + word.size();
+			
+			int base = 10;
+			if (word.size() > 2 && word[0] == '0' && (word[1] == 'x' || word[1] == 'X')) {
+				base = 16;
+				first += 2;
+			} else if (word.size() > 1 && word[0] == '0') {
+				base = 8;
+			}
+			
+			unsigned long long integer;
+			std::from_chars_result result = std::from_chars(first, last, integer, base);
+			if (result.ec == std::errc() && result.ptr == last) {
+				endptr = last;
+				return double(integer);
+			}
+			
+			double num = 0;
+			endptr = std::from_chars(word.data(), last, num).ptr;
+			return num;
+		}
+		
 		token fetch_word(push_back_stream& stream) {
 			size_t line_number = stream.line_number();
 			size_t char_index = stream.char_index();
 
-			std::string word;
-			
 			int c = stream();
 			
 			bool is_number = isdigit(c);
 			
 			do {
-				word.push_back(char(c));
+				int prev = c;
 				c = stream();
 				
-				if (c == '.' && word.back() == '.') {
-					stream.push_back(word.back());
-					word.pop_back();
+				if (c == '.' && prev == '.') {
+					stream.push_back(c);
+					c = prev;
 					break;
 				}
 			} while (get_character_type(c) == character_type::alphanum || (is_number && c == '.'));
 			
 			stream.push_back(c);
 			
+			std::string_view word = stream.view(char_index, stream.char_index());
+			
 			if (std::optional<reserved_token> t  = get_keyword(word)) {
 				return token(*t, line_number, char_index);
 			} else {
 				if (std::isdigit(word.front())) {
-					char* endptr;
-					double num = strtol(word.c_str(), &endptr, 0);
-					if (*endptr != 0) {
-						num = strtod(word.c_str(), &endptr);
-						if (*endptr != 0) {
-							size_t remaining = word.size() - (endptr - word.c_str());
-							throw unexpected_error(
-								std::string(1, char(*endptr)),
-								stream.line_number(),
-								stream.char_index() - remaining
-							);
-						}
+					const char* endptr;
+					double num = parse_number(word, endptr);
+					if (endptr != word.data() + word.size()) {
+						size_t remaining = word.size() - (endptr - word.data());
+						throw unexpected_error(
+							std::string(1, *endptr),
+							stream.line_number(),
+							stream.char_index() - remaining
+						);
 					}
 					return token(num, line_number, char_index);
 				} else {
-					return token(identifier{std::move(word)}, line_number, char_index);
+					return token(identifier{intern(word)}, line_number, char_index);
 				}
 			}
 		}
@@ -132,7 +153,7 @@ namespace stork {
 								stream.push_back(c);
 								throw parsing_error("Expected closing '\"'", stream.line_number(), stream.char_index());
 							case '"':
-								return token(std::move(str), line_number, char_index);
+								return token(string_literal{intern(str)}, line_number, char_index);
 							default:
 								str.push_back(c);
 						}
@@ -219,6 +240,21 @@ namespace stork {
 		++(*this);
 	}
 	
+	tokens_iterator::tokens_iterator(std::span<push_back_stream> streams):
+		_get_next_token([streams, idx = size_t(0)]() mutable {
+			for (;;) {
+				token ret = tokenize(streams[idx]);
+				if (!ret.is_eof() || idx + 1 == streams.size()) {
+					return ret;
+				}
+				++idx;
+			}
+		}),
+		_current(eof(), 0, 0)
+	{
+		++(*this);
+	}
+	
 	tokens_iterator::tokens_iterator(std::deque<token>& tokens):
 		_current(eof(), 0, 0),
 		_get_next_token([&tokens](){
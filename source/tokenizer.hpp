@@ -6,6 +6,7 @@
 #include <iostream>
 #include <variant>
 #include <deque>
+#include <span>
 
 #include "tokens.hpp"
 
@@ -20,6 +21,7 @@ namespace stork {
 		token _current;
 	public:
 		tokens_iterator(push_back_stream& stream);
+		tokens_iterator(std::span<push_back_stream> streams);
 		tokens_iterator(std::deque<token>& tokens);
 		
 		const token& operator*() const;
@@ -95,6 +95,7 @@ namespace stork {
 			{"number", reserved_token::kw_number},
 			{"string", reserved_token::kw_string},
 			
+			{"const", reserved_token::kw_const},
 			{"public", reserved_token::kw_public}
 		};
 		
@@ -191,7 +192,7 @@ namespace stork {
 	}
 	
 	bool token::is_string() const {
-		return std::holds_alternative<std::string>(_value);
+		return std::holds_alternative<string_literal>(_value);
 	}
 	
 	bool token::is_eof() const {
@@ -210,8 +211,8 @@ namespace stork {
 		return std::get<double>(_value);
 	}
 	
-	const std::string& token::get_string() const {
-		return std::get<std::string>(_value);
+	std::string_view token::get_string() const {
+		return std::get<string_literal>(_value).value();
 	}
 	
 	const token_value& token::get_value() const {
@@ -230,12 +231,28 @@ namespace stork {
 		return _value == value;
 	}
 	
+	std::string_view identifier::name() const {
+		return symbol_name(id);
+	}
+	
 	bool operator==(const identifier& id1, const identifier& id2) {
-		return id1.name == id2.name;
+		return id1.id == id2.id;
 	}
 	
 	bool operator!=(const identifier& id1, const identifier& id2) {
-		return id1.name != id2.name;
+		return id1.id != id2.id;
+	}
+	
+	std::string_view string_literal::value() const {
+		return symbol_name(id);
+	}
+	
+	bool operator==(const string_literal& s1, const string_literal& s2) {
+		return s1.id == s2.id;
+	}
+	
+	bool operator!=(const string_literal& s1, const string_literal& s2) {
+		return s1.id != s2.id;
 	}
 	
 	bool operator==(const eof&, const eof&) {
@@ -260,10 +277,10 @@ namespace std {
 					return to_string(t);
 				} else if constexpr (std::is_same_v<decltype(t), const double&>) {
 					return to_string(t);
-				} else if constexpr (std::is_same_v<decltype(t), const std::string&>) {
-					return t;
+				} else if constexpr (std::is_same_v<decltype(t), const string_literal&>) {
+					return std::string(t.value());
 				} else if constexpr (std::is_same_v<decltype(t), const identifier&>) {
-					return t.name;
+					return std::string(t.name());
 				} else if constexpr (std::is_same_v<decltype(t), const eof&>) {
 					return std::string("<EOF>");
 				}
@@ -5,6 +5,9 @@
 #include <string_view>
 #include <ostream>
 #include <variant>
+#include <type_traits>
+#include <string>
+#include "symbols.hpp"
 
 namespace stork {
 	enum struct reserved_token {
@@ -94,6 +97,7 @@ namespace stork {
 		kw_number,
 		kw_string,
 		
+		kw_const,
 		kw_public,
 	};
 	
@@ -106,19 +110,30 @@ namespace stork {
 	std::optional<reserved_token> get_operator(push_back_stream& stream);
 	
 	struct identifier{
-		std::string name;
+		symbol id;
+		
+		std::string_view name() const;
 	};
 	
 	bool operator==(const identifier& id1, const identifier& id2);
 	bool operator!=(const identifier& id1, const identifier& id2);
 	
+	struct string_literal{
+		symbol id;
+		
+		std::string_view value() const;
+	};
+	
+	bool operator==(const string_literal& s1, const string_literal& s2);
+	bool operator!=(const string_literal& s1, const string_literal& s2);
+	
 	struct eof{
 	};
 	
 	bool operator==(const eof&, const eof&);
 	bool operator!=(const eof&, const eof&);
 
-	using token_value = std::variant<reserved_token, identifier, double, std::string, eof>;
+	using token_value = std::variant<reserved_token, identifier, double, string_literal, eof>;
 
 	class token {
 	private:
@@ -137,7 +152,7 @@ namespace stork {
 		reserved_token get_reserved_token() const;
 		const identifier& get_identifier() const;
 		double get_number() const;
-		const std::string& get_string() const;
+		std::string_view get_string() const;
 		const token_value& get_value() const;
 		
 		size_t get_line_number() const;
@@ -145,6 +160,8 @@ namespace stork {
 
 		bool has_value(const token_value& value) const;
 	};
+	
+	static_assert(std::is_trivially_copyable_v<token>);
 }
 
 namespace std {
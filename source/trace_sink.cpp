@@ -0,0 +1,100 @@
+#include "trace_sink.hpp"
+#include <iostream>
+
+namespace stork {
+	trace_sink::trace_sink(output out, size_t capacity, trace_overflow overflow):
+		_output(std::move(out)),
+		_capacity(capacity),
+		_overflow(overflow),
+		_writing(false),
+		_stopped(false),
+		_dropped(0)
+	{
+	}
+	
+	void trace_sink::trace(std::string_view line) {
+		std::unique_lock<std::mutex> lock(_mutex);
+		
+		if (!_writer.joinable()) {
+			_writer = std::thread([this]() {
+				run();
+			});
+		}
+		
+		while (!_pending.empty() && _pending.size() + line.size() + 1 > _capacity) {
+			if (_overflow == trace_overflow::drop) {
+				++_dropped;
+				return;
+			}
+			_tracer_cv.wait(lock);
+		}
+		
+		bool was_empty = _pending.empty();
+		_pending.append(line);
+		_pending.push_back('\n');
+		
+		if (was_empty) {
+			_writer_cv.notify_one();
+		}
+	}
+	
+	void trace_sink::flush() {
+		std::unique_lock<std::mutex> lock(_mutex);
+		_tracer_cv.wait(lock, [this]() {
+			return _pending.empty() && !_writing;
+		});
+	}
+	
+	size_t trace_sink::dropped() const {
+		std::lock_guard<std::mutex> lock(_mutex);
+		return _dropped;
+	}
+	
+	void trace_sink::run() {
+		std::string chunk;
+		std::unique_lock<std::mutex> lock(_mutex);
+		
+		for (;;) {
+			_writer_cv.wait(lock, [this]() {
+				return !_pending.empty() || _stopped;
+			});
+			
+			if (_pending.empty()) {
+				return;
+			}
+			
+			chunk.clear();
+			std::swap(chunk, _pending);
+			_writing = true;
+			_tracer_cv.notify_all();
+			
+			lock.unlock();
+			try {
+				_output(chunk);
+			} catch (...) {
+			}
+			lock.lock();
+			
+			_writing = false;
+			_tracer_cv.notify_all();
+		}
+	}
+	
+	trace_sink::~trace_sink() {
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			_stopped = true;
+		}
+		_writer_cv.notify_one();
+		if (_writer.joinable()) {
+			_writer.join();
+		}
+	}
+	
+	trace_sink::output standard_output() {
+		return [](std::string_view chunk) {
+			std::cout.write(chunk.data(), chunk.size());
+			std::cout.flush();
+		};
+	}
+}
@@ -0,0 +1,52 @@
+#ifndef trace_sink_hpp
+#define trace_sink_hpp
+
+#include <string>
+#include <string_view>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+namespace stork {
+	enum struct trace_overflow {
+		block,
+		drop,
+	};
+	
+	class trace_sink {
+		trace_sink(const trace_sink&) = delete;
+		void operator=(const trace_sink&) = delete;
+	public:
+		// Receives chunks of complete, newline-terminated lines on the writer thread.
+		using output = std::function<void(std::string_view)>;
+	private:
+		output _output;
+		size_t _capacity;
+		trace_overflow _overflow;
+		mutable std::mutex _mutex;
+		std::condition_variable _writer_cv;
+		std::condition_variable _tracer_cv;
+		std::string _pending;
+		bool _writing;
+		bool _stopped;
+		size_t _dropped;
+		std::thread _writer;
+		
+		void run();
+	public:
+		explicit trace_sink(output out, size_t capacity = 1 << 16, trace_overflow overflow = trace_overflow::block);
+		
+		void trace(std::string_view line);
+		
+		void flush();
+		
+		size_t dropped() const;
+		
+		~trace_sink();
+	};
+	
+	trace_sink::output standard_output();
+}
+
+#endif /* trace_sink_hpp */
@@ -2,74 +2,78 @@
 #include <cassert>
 
 namespace stork {
-	bool type_registry::types_less::operator()(const type& t1, const type& t2) const {
-		const size_t idx1 = t1.index();
-		const size_t idx2 = t2.index();
+	namespace {
+		size_t hash_combine(size_t seed, size_t value) {
+			return seed ^ (value + 0x9e3779b97f4a7c15ull + (seed << 6) + (seed >> 2));
+		}
 		
-		if (idx1 != idx2) {
-			return idx1 < idx2;
+		size_t hash_handles(size_t seed, const std::vector<type_handle>& handles) {
+			seed = hash_combine(seed, handles.size());
+			for (type_handle h : handles) {
+				seed = hash_combine(seed, std::hash<type_handle>()(h));
+			}
+			return seed;
 		}
+	}
+	
+	size_t type_registry::types_hash::operator()(const type& t) const {
+		size_t seed = t.index();
 		
-		switch (idx1) {
+		switch (t.index()) {
 			case 0:
-				return std::get<0>(t1) < std::get<0>(t2);
+				return hash_combine(seed, size_t(std::get<0>(t)));
 			case 1:
-				return std::get<1>(t1).inner_type_id < std::get<1>(t2).inner_type_id;
+				return hash_combine(seed, std::hash<type_handle>()(std::get<1>(t).inner_type_id));
 			case 2:
 			{
-				const function_type& ft1 = std::get<2>(t1);
-				const function_type& ft2 = std::get<2>(t2);
-				
-				if (ft1.return_type_id != ft2.return_type_id) {
-					return ft1.return_type_id < ft2.return_type_id;
-				}
-				
-				if (ft1.param_type_id.size() != ft2.param_type_id.size()) {
-					return ft1.param_type_id.size() < ft2.param_type_id.size();
+				const function_type& ft = std::get<2>(t);
+				seed = hash_combine(seed, std::hash<type_handle>()(ft.return_type_id));
+				seed = hash_combine(seed, ft.param_type_id.size());
+				for (const function_type::param& p : ft.param_type_id) {
+					seed = hash_combine(seed, std::hash<type_handle>()(p.type_id));
+					seed = hash_combine(seed, p.by_ref);
 				}
-				
-				for (size_t i = 0; i < ft1.param_type_id.size(); ++i) {
-					if (ft1.param_type_id[i].type_id != ft2.param_type_id[i].type_id) {
-						return ft1.param_type_id[i].type_id < ft2.param_type_id[i].type_id;
-					}
-					if (ft1.param_type_id[i].by_ref != ft2.param_type_id[i].by_ref) {
-						return ft2.param_type_id[i].by_ref;
-					}
-				}
-				return false;
+				return seed;
 			}
 			case 3:
-			{
-				const tuple_type& tt1 = std::get<3>(t1);
-				const tuple_type& tt2 = std::get<3>(t2);
-				
-				if (tt1.inner_type_id.size() != tt2.inner_type_id.size()) {
-					return tt1.inner_type_id.size() < tt2.inner_type_id.size();
-				}
-				
-				for (size_t i = 0; i < tt1.inner_type_id.size(); ++i) {
-					if (tt1.inner_type_id[i] != tt2.inner_type_id[i]) {
-						return tt1.inner_type_id[i] < tt2.inner_type_id[i];
-					}
-				}
-				return false;
-			}
+				return hash_handles(seed, std::get<3>(t).inner_type_id);
 			case 4:
+				return hash_handles(seed, std::get<4>(t).inner_type_id);
+		}
+		
+		return seed;
+	}
+	
+	bool type_registry::types_equal::operator()(const type& t1, const type& t2) const {
+		if (t1.index() != t2.index()) {
+			return false;
+		}
+		
+		switch (t1.index()) {
+			case 0:
+				return std::get<0>(t1) == std::get<0>(t2);
+			case 1:
+				return std::get<1>(t1).inner_type_id == std::get<1>(t2).inner_type_id;
+			case 2:
 			{
-				const init_list_type& ilt1 = std::get<4>(t1);
-				const init_list_type& ilt2 = std::get<4>(t2);
+				const function_type& ft1 = std::get<2>(t1);
+				const function_type& ft2 = std::get<2>(t2);
 				
-				if (ilt1.inner_type_id.size() != ilt2.inner_type_id.size()) {
-					return ilt1.inner_type_id.size() < ilt2.inner_type_id.size();
+				if (ft1.return_type_id != ft2.return_type_id || ft1.param_type_id.size() != ft2.param_type_id.size()) {
+					return false;
 				}
 				
-				for (size_t i = 0; i < ilt1.inner_type_id.size(); ++i) {
-					if (ilt1.inner_type_id[i] != ilt2.inner_type_id[i]) {
-						return ilt1.inner_type_id[i] < ilt2.inner_type_id[i];
+				for (size_t i = 0; i < ft1.param_type_id.size(); ++i) {
+					if (ft1.param_type_id[i].type_id != ft2.param_type_id[i].type_id || ft1.param_type_id[i].by_ref != ft2.param_type_id[i].by_ref) {
+						return false;
 					}
 				}
-				return false;
+				return true;
 			}
+			case 3:
+				return std::get<3>(t1).inner_type_id == std::get<3>(t2).inner_type_id;
+			case 4:
+				return std::get<4>(t1).inner_type_id == std::get<4>(t2).inner_type_id;
 		}
 		
 		return false;
@@ -92,6 +96,7 @@ namespace stork {
 				assert(0);
 				return type_registry::get_void_handle(); //cannot happen;
 			} else {
+				std::lock_guard<std::mutex> lock(_mutex);
 				return &(*(_types.insert(t).first));
 			}
 		}, t);
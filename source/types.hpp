@@ -2,7 +2,8 @@
 #define types_h
 #include <vector>
 #include <variant>
-#include <set>
+#include <unordered_set>
+#include <mutex>
 #include <ostream>
 
 namespace stork {
@@ -43,10 +44,14 @@ namespace stork {
 	
 	class type_registry {
 	private:
-		struct types_less{
+		struct types_hash{
+			size_t operator()(const type& t) const;
+		};
+		struct types_equal{
 			bool operator()(const type& t1, const type& t2) const;
 		};
-		std::set<type, types_less> _types;
+		std::mutex _mutex;
+		std::unordered_set<type, types_hash, types_equal> _types;
 		
 		static type void_type;
 		static type number_type;
@@ -1,4 +1,6 @@
 #include "variable.hpp"
+#include <charconv>
+#include <cmath>
 
 namespace stork {
 	namespace {
@@ -18,11 +20,21 @@ namespace stork {
 		return std::make_shared<variable_impl<T> >(clone_variable_value(value));
 	}
 	
+	template<typename T>
+	void variable_impl<T>::restore(const variable& snapshot) {
+		restore_variable_value(value, static_cast<const variable_impl<T>&>(snapshot).value);
+	}
+	
 	template<typename T>
 	string variable_impl<T>::to_string() const {
 		return convert_to_string(value);
 	}
 	
+	template<typename T>
+	void variable_impl<T>::append_to_string(std::string& out) const {
+		stork::append_to_string(out, value);
+	}
+	
 	template class variable_impl<number>;
 	template class variable_impl<string>;
 	template class variable_impl<function>;
@@ -48,31 +60,82 @@ namespace stork {
 		return ret;
 	}
 	
-	string convert_to_string(number value) {
-		if (value == int(value)) {
-			return from_std_string(std::to_string(int(value)));
+	void restore_variable_value(number& value, number snapshot) {
+		value = snapshot;
+	}
+	
+	void restore_variable_value(string& value, const string& snapshot) {
+		value = snapshot;
+	}
+	
+	void restore_variable_value(function& value, const function& snapshot) {
+		value = snapshot;
+	}
+	
+	void restore_variable_value(array& value, const array& snapshot) {
+		if (value.size() != snapshot.size()) {
+			value = clone_variable_value(snapshot);
+			return;
+		}
+		for (size_t i = 0; i < value.size(); ++i) {
+			if (value[i].use_count() == 1) {
+				value[i]->restore(*snapshot[i]);
+			} else {
+				value[i] = snapshot[i]->clone();
+			}
+		}
+	}
+	
+	void append_to_string(std::string& out, number value) {
+		char buffer[32];
+		std::to_chars_result result;
+		if (value == 0) {
+			out += '0';
+			return;
+		} else if (std::fabs(value) < 0x1p53 && value == std::trunc(value)) {
+			result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed);
 		} else {
-			return from_std_string(std::to_string(value));
+			result = std::to_chars(buffer, buffer + sizeof(buffer), value);
 		}
+		out.append(buffer, result.ptr);
 	}
 	
-	string convert_to_string(const string& value) {
-		return value;
+	void append_to_string(std::string& out, const string& value) {
+		out += *value;
 	}
 	
-	string convert_to_string(const function& value) {
-		return from_std_string("FUNCTION");
+	void append_to_string(std::string& out, const function&) {
+		out += "FUNCTION";
 	}
 	
-	string convert_to_string(const array& value) {
-		std::string ret = "[";
+	void append_to_string(std::string& out, const array& value) {
+		out += '[';
 		const char* separator = "";
 		for (const variable_ptr& v : value) {
-			ret += separator;
-			ret += *(v->to_string());
+			out += separator;
+			v->append_to_string(out);
 			separator = ", ";
 		}
-		ret += "]";
+		out += ']';
+	}
+	
+	string convert_to_string(number value) {
+		std::string ret;
+		append_to_string(ret, value);
+		return from_std_string(std::move(ret));
+	}
+	
+	string convert_to_string(const string& value) {
+		return value;
+	}
+	
+	string convert_to_string(const function&) {
+		return from_std_string("FUNCTION");
+	}
+	
+	string convert_to_string(const array& value) {
+		std::string ret;
+		append_to_string(ret, value);
 		return from_std_string(std::move(ret));
 	}
 	
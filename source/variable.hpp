@@ -50,7 +50,11 @@ namespace stork {
 		
 		virtual variable_ptr clone() const = 0;
 		
+		virtual void restore(const variable& snapshot) = 0;
+		
 		virtual string to_string() const = 0;
+		
+		virtual void append_to_string(std::string& out) const = 0;
 	};
 	
 	template<typename T>
@@ -63,8 +67,12 @@ namespace stork {
 		variable_impl(value_type value);
 		
 		variable_ptr clone() const override;
+		
+		void restore(const variable& snapshot) override;
 	
 		string to_string() const override;
+		
+		void append_to_string(std::string& out) const override;
 	};
 	
 	number clone_variable_value(number value);
@@ -77,6 +85,16 @@ namespace stork {
 		return clone_variable_value(v->value);
 	}
 	
+	void restore_variable_value(number& value, number snapshot);
+	void restore_variable_value(string& value, const string& snapshot);
+	void restore_variable_value(function& value, const function& snapshot);
+	void restore_variable_value(array& value, const array& snapshot);
+	
+	void append_to_string(std::string& out, number value);
+	void append_to_string(std::string& out, const string& value);
+	void append_to_string(std::string& out, const function& value);
+	void append_to_string(std::string& out, const array& value);
+	
 	string convert_to_string(number value);
 	string convert_to_string(const string& value);
 	string convert_to_string(const function& value);
@@ -0,0 +1,124 @@
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include "module.hpp"
+#include "standard_functions.hpp"
+#include "channel.hpp"
+
+namespace {
+	const char* producer_source =
+		"public function void produce(number ch, number count) {\n"
+		"	for (number i = 1; i <= count; ++i) {\n"
+		"		send(ch, i);\n"
+		"	}\n"
+		"	close_channel(ch);\n"
+		"}\n";
+	
+	const char* consumer_source =
+		"public function number consume(number ch, number count) {\n"
+		"	number sum = 0;\n"
+		"	for (number i = 0; i < count; ++i) {\n"
+		"		sum += receive(ch) * 2;\n"
+		"	}\n"
+		"	return sum;\n"
+		"}\n"
+		"public function number receive_one(number ch) {\n"
+		"	return receive(ch);\n"
+		"}\n";
+	
+	bool expect(const char* name, stork::number actual, stork::number expected) {
+		if (actual != expected) {
+			std::cerr << name << ": expected " << expected << ", got " << actual << std::endl;
+			return false;
+		}
+		return true;
+	}
+	
+	bool expect_closed(const char* name, const std::function<void()>& f) {
+		try {
+			f();
+		} catch (const stork::runtime_error& e) {
+			if (std::string(e.what()) == "Channel is closed") {
+				return true;
+			}
+			std::cerr << name << ": unexpected error '" << e.what() << "'" << std::endl;
+			return false;
+		}
+		std::cerr << name << ": receive did not report a closed channel" << std::endl;
+		return false;
+	}
+	
+	bool test_shared_registry() {
+		using namespace stork;
+		
+		std::shared_ptr<channel_registry> channels = std::make_shared<channel_registry>();
+		
+		stork_module producer;
+		add_channel_functions(producer, channels);
+		auto produce = producer.create_public_function_caller<void, number, number>("produce");
+		producer.load_source(producer_source);
+		
+		stork_module consumer;
+		add_channel_functions(consumer, channels);
+		auto consume = consumer.create_public_function_caller<number, number, number>("consume");
+		auto receive_one = consumer.create_public_function_caller<number, number>("receive_one");
+		consumer.load_source(consumer_source);
+		
+		const number count = 1000;
+		number ch = number(channels->create(16));
+		
+		number sum = 0;
+		std::thread stage([&]() {
+			sum = consume(ch, count);
+		});
+		produce(ch, count);
+		stage.join();
+		
+		bool ok = expect("pipeline sum", sum, count * (count + 1));
+		ok &= expect_closed("pipeline end", [&]() {
+			receive_one(ch);
+		});
+		return ok;
+	}
+	
+	bool test_close_keeps_queued_values() {
+		using namespace stork;
+		
+		stork_module m;
+		add_channel_functions(m);
+		auto produce = m.create_public_function_caller<void, number, number>("produce");
+		auto receive_one = m.create_public_function_caller<number, number>("receive_one");
+		auto create = m.create_public_function_caller<number>("create");
+		m.load_source(std::string(producer_source) +
+			"public function number receive_one(number ch) {\n"
+			"	return receive(ch);\n"
+			"}\n"
+			"public function number create() {\n"
+			"	return channel(4);\n"
+			"}\n"
+		);
+		
+		number ch = create();
+		produce(ch, 3);
+		
+		bool ok = true;
+		ok &= expect("first queued value", receive_one(ch), 1);
+		ok &= expect("second queued value", receive_one(ch), 2);
+		ok &= expect("third queued value", receive_one(ch), 3);
+		ok &= expect_closed("drained channel", [&]() {
+			receive_one(ch);
+		});
+		return ok;
+	}
+}
+
+int main() {
+	bool ok = true;
+	
+	ok &= test_shared_registry();
+	ok &= test_close_keeps_queued_values();
+	
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
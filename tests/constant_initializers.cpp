@@ -0,0 +1,90 @@
+#include <cstdlib>
+#include <iostream>
+#include "module.hpp"
+#include "compiler_context.hpp"
+#include "expression.hpp"
+#include "push_back_stream.hpp"
+#include "tokenizer.hpp"
+
+namespace {
+	const char* source =
+		"number x = -1;\n"
+		"number y = 2 * 3;\n"
+		"const number k = 4;\n"
+		"number z = k + 1;\n"
+		"string s = \"a\" .. \"b\";\n"
+		"public function number sum() {\n"
+		"	return x + y + z;\n"
+		"}\n"
+		"public function string text() {\n"
+		"	return s;\n"
+		"}\n"
+		"public function void change() {\n"
+		"	x = 100;\n"
+		"	y = 200;\n"
+		"	z = 300;\n"
+		"	s = \"changed\";\n"
+		"}\n";
+	
+	bool expect_constant(stork::compiler_context& context, const char* text, bool expected) {
+		stork::push_back_stream stream(text);
+		stork::tokens_iterator it(stream);
+		bool constant = stork::build_initialization_expression(
+			context, it, context.get_handle(stork::simple_type::number), false
+		)->is_constant();
+		
+		if (constant != expected) {
+			std::cerr << "'" << text << "': is_constant() returned " << constant << ", expected " << expected << std::endl;
+			return false;
+		}
+		return true;
+	}
+	
+	template<typename T>
+	bool expect(const char* name, const T& actual, const T& expected) {
+		if (actual != expected) {
+			std::cerr << name << ": " << actual << ", expected " << expected << std::endl;
+			return false;
+		}
+		return true;
+	}
+}
+
+int main() {
+	using namespace stork;
+	
+	bool ok = true;
+	
+	{
+		compiler_context context;
+		type_handle number_handle = context.get_handle(simple_type::number);
+		context.add_constant_global(context.create_identifier("k", number_handle, true)->index());
+		context.create_identifier("v", number_handle, false);
+		
+		ok &= expect_constant(context, "-1;", true);
+		ok &= expect_constant(context, "2 * 3;", true);
+		ok &= expect_constant(context, "(1 + 2) / 4 - -5;", true);
+		ok &= expect_constant(context, "k * 2;", true);
+		ok &= expect_constant(context, "v * 2;", false);
+		ok &= expect_constant(context, "k + v;", false);
+	}
+	
+	{
+		stork_module m;
+		auto sum = m.create_public_function_caller<number>("sum");
+		auto text = m.create_public_function_caller<std::string>("text");
+		auto change = m.create_public_function_caller<void>("change");
+		m.load_source(source);
+		
+		ok &= expect("initial sum", sum(), number(10));
+		ok &= expect("initial text", text(), std::string("ab"));
+		
+		change();
+		m.reset_globals();
+		
+		ok &= expect("sum after reset", sum(), number(10));
+		ok &= expect("text after reset", text(), std::string("ab"));
+	}
+	
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,85 @@
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include "module.hpp"
+
+namespace {
+	size_t allocations = 0;
+	
+	constexpr int warm_up_calls = 16;
+	constexpr int measured_calls = 10000;
+	
+	const char* source =
+		"public function number add(number a, number b) {\n"
+		"	return a + b * 2;\n"
+		"}\n"
+		"public function number measure(string s, number n) {\n"
+		"	return sizeof(s) + n;\n"
+		"}\n"
+		"public function string echo(string s) {\n"
+		"	return s;\n"
+		"}\n";
+	
+	template<typename F>
+	bool expect_no_allocations(const char* name, F f) {
+		for (int i = 0; i < warm_up_calls; ++i) {
+			f(i);
+		}
+		
+		size_t before = allocations;
+		for (int i = 0; i < measured_calls; ++i) {
+			f(i);
+		}
+		size_t count = allocations - before;
+		
+		if (count != 0) {
+			std::cerr << name << ": " << count << " allocations in " << measured_calls << " calls" << std::endl;
+			return false;
+		}
+		return true;
+	}
+}
+
+void* operator new(size_t size) {
+	++allocations;
+	if (void* ptr = std::malloc(size ? size : 1)) {
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+	std::free(ptr);
+}
+
+int main() {
+	using namespace stork;
+	
+	stork_module m;
+	auto add = m.create_public_function_caller<number, number, number>("add");
+	auto measure = m.create_public_function_caller<number, std::string, number>("measure");
+	auto echo = m.create_public_function_caller<std::string, std::string>("echo");
+	m.load_source(source);
+	
+	const std::string long_string = "a string long enough to live outside the small string buffer";
+	const std::string short_string = "short";
+	
+	bool ok = true;
+	
+	ok &= expect_no_allocations("number", [&](int i) {
+		return add(i, 1);
+	});
+	ok &= expect_no_allocations("string argument", [&](int i) {
+		return measure(long_string, i);
+	});
+	ok &= expect_no_allocations("string result", [&](int) {
+		return echo(short_string);
+	});
+	
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
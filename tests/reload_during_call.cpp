@@ -0,0 +1,56 @@
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include "module.hpp"
+
+namespace {
+	const char* first_version =
+		"number calls = 0;\n"
+		"public function number version() {\n"
+		"	++calls;\n"
+		"	reload();\n"
+		"	number[] padding = {1, 2, 3};\n"
+		"	return 1 + sizeof(padding) - 3;\n"
+		"}\n"
+		"public function number count() {\n"
+		"	return calls;\n"
+		"}\n";
+	
+	const char* second_version =
+		"number calls = 0;\n"
+		"public function number version() {\n"
+		"	++calls;\n"
+		"	return 2;\n"
+		"}\n"
+		"public function number count() {\n"
+		"	return calls;\n"
+		"}\n";
+	
+	bool expect(const char* name, stork::number actual, stork::number expected) {
+		if (actual != expected) {
+			std::cerr << name << ": expected " << expected << ", got " << actual << std::endl;
+			return false;
+		}
+		return true;
+	}
+}
+
+int main() {
+	using namespace stork;
+	
+	stork_module m;
+	m.add_external_function("reload", std::function<void()>([&m]() {
+		m.reload_source(second_version);
+	}));
+	auto version = m.create_public_function_caller<number>("version");
+	auto count = m.create_public_function_caller<number>("count");
+	m.load_source(first_version);
+	
+	bool ok = true;
+	
+	ok &= expect("call that reloads", version(), 1);
+	ok &= expect("call after reload", version(), 2);
+	ok &= expect("global kept across reload", count(), 2);
+	
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,128 @@
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include "module.hpp"
+#include "standard_functions.hpp"
+#include "errors.hpp"
+
+namespace {
+	size_t live_allocations = 0;
+	
+	const char* source =
+		"string trail;\n"
+		"function void worker(number n) {\n"
+		"	trail = trail .. \"a\" .. tostring(n);\n"
+		"	yield();\n"
+		"	trail = trail .. \"b\" .. tostring(n);\n"
+		"}\n"
+		"function void named(string s) {\n"
+		"	trail = trail .. s;\n"
+		"}\n"
+		"function void plain() {\n"
+		"	trail = trail .. \"p\";\n"
+		"}\n"
+		"function void failing(number n) {\n"
+		"	fail();\n"
+		"}\n"
+		"public function string interleave() {\n"
+		"	trail = \"\";\n"
+		"	number t1 = spawn(worker, 1);\n"
+		"	number t2 = spawn(worker, 2);\n"
+		"	join(t1);\n"
+		"	join(t2);\n"
+		"	return trail;\n"
+		"}\n"
+		"public function string variants() {\n"
+		"	trail = \"\";\n"
+		"	join(spawn_string(named, \"s\"));\n"
+		"	join(spawn_void(plain));\n"
+		"	return trail;\n"
+		"}\n"
+		"public function void join_failing() {\n"
+		"	join(spawn(failing, 0));\n"
+		"}\n"
+		"public function void fire_and_forget(number count) {\n"
+		"	number[] ids;\n"
+		"	for (number i = 0; i < count; ++i) {\n"
+		"		detach(spawn(worker, i));\n"
+		"		ids[i] = spawn(worker, i);\n"
+		"	}\n"
+		"	yield();\n"
+		"	yield();\n"
+		"	for (number i = 0; i < count; ++i) {\n"
+		"		detach(ids[i]);\n"
+		"	}\n"
+		"	trail = \"\";\n"
+		"}\n";
+	
+	bool expect(const char* name, const std::string& actual, const std::string& expected) {
+		if (actual != expected) {
+			std::cerr << name << ": '" << actual << "', expected '" << expected << "'" << std::endl;
+			return false;
+		}
+		return true;
+	}
+}
+
+void* operator new(size_t size) {
+	++live_allocations;
+	if (void* ptr = std::malloc(size ? size : 1)) {
+		return ptr;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept {
+	if (ptr) {
+		--live_allocations;
+	}
+	std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+	if (ptr) {
+		--live_allocations;
+	}
+	std::free(ptr);
+}
+
+int main() {
+	using namespace stork;
+	
+	bool ok = true;
+	
+	stork_module m;
+	add_standard_functions(m);
+	m.add_external_function("fail", std::function<void()>([]() {
+		throw runtime_error("task failed");
+	}));
+	
+	auto interleave = m.create_public_function_caller<std::string>("interleave");
+	auto variants = m.create_public_function_caller<std::string>("variants");
+	auto join_failing = m.create_public_function_caller<void>("join_failing");
+	auto fire_and_forget = m.create_public_function_caller<void, number>("fire_and_forget");
+	m.load_source(source);
+	
+	ok &= expect("interleave", interleave(), "a1a2b1b2");
+	ok &= expect("variants", variants(), "sp");
+	
+	try {
+		join_failing();
+		ok &= expect("join_failing", "no error", "task failed");
+	} catch (const runtime_error& e) {
+		ok &= expect("join_failing", e.what(), "task failed");
+	}
+	
+	fire_and_forget(100);
+	size_t before = live_allocations;
+	for (int i = 0; i < 10; ++i) {
+		fire_and_forget(100);
+	}
+	if (live_allocations != before) {
+		std::cerr << "fire_and_forget: " << live_allocations - before << " allocations still live" << std::endl;
+		ok = false;
+	}
+	
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}